@@ -30,6 +30,12 @@
 #include <cmath>
 #include <ctime>
 #include <cstdlib>
+#include <thread>
+#include <mutex>
+#include <deque>
+#include <functional>
+#include <atomic>
+#include <unordered_map>
 
 using namespace std;
 
@@ -68,10 +74,13 @@ struct Proveedor {
 
 // Producto: Estructura que almacena la información de un producto.
 struct Producto {
+    int id;
     string codigo;
     string nombre;
     float precio;
     int cantidad;
+    // Cantidad a partir de la cual se debe pedir el producto al proveedor:
+    int stock_minimo;
     string descripcion;
     string categoria;
     // Enlazar con el proveedor
@@ -101,6 +110,380 @@ struct DetalleVenta {
     float subtotal;
 };
 
+// OperacionMasiva: Estructura que almacena un filtro y un cambio a aplicar sobre todos los productos que
+// cumplan el filtro.
+// Filtros: todos, categoria <nombre>, proveedor <nombre>, stock_menor <cantidad>, estado <0|1>.
+// Cambios: precio_porcentaje <porcentaje>, precio <valor>, cantidad_sumar <cantidad>, cantidad <valor>, estado <0|1>.
+struct OperacionMasiva {
+    string filtro;
+    string valor_filtro;
+    string cambio;
+    float valor_cambio;
+};
+
+// Filtros y cambios de una operación masiva, para no comparar sus nombres con cada producto:
+enum FiltroOperacion { FILTRO_TODOS, FILTRO_CATEGORIA, FILTRO_PROVEEDOR, FILTRO_STOCK_MENOR, FILTRO_ESTADO, FILTRO_NO_VALIDO };
+enum CambioOperacion { CAMBIO_PRECIO_PORCENTAJE, CAMBIO_PRECIO, CAMBIO_CANTIDAD_SUMAR, CAMBIO_CANTIDAD, CAMBIO_ESTADO, CAMBIO_NO_VALIDO };
+
+// TablaIds: Tabla de acceso directo para una entidad. Asigna ids consecutivos que nunca se reutilizan
+// y guarda, en la posición igual al id, un iterador al elemento dentro de su lista, de modo que
+// buscar por id es un solo acceso al vector. Los ids eliminados quedan marcados como libres.
+template <typename T>
+struct TablaIds {
+    // Los ids se limitan para que un id muy grande en un archivo no obligue a reservar una tabla enorme:
+    // como máximo MARGEN_IDS por encima del siguiente id y nunca MAXIMO_ID o más.
+    static const int MARGEN_IDS = 100000;
+    static const int MAXIMO_ID = 100000000;
+    int siguiente_id = 1;
+    vector<typename list<T>::iterator> posiciones;
+    vector<bool> ocupado;
+    // Versión de la tabla: aumenta con cada cambio en sus elementos y sirve para invalidar la caché de consultas.
+    long version = 0;
+
+    // Reservar el siguiente id disponible:
+    int asignarId(){
+        return siguiente_id++;
+    }
+
+    // Indicar si el id está dentro de los límites de la tabla:
+    bool idEnRango(int id) const {
+        return id > 0 && id < MAXIMO_ID && id <= siguiente_id + MARGEN_IDS;
+    }
+
+    // Indicar si el id se puede registrar (dentro de los límites y no usado por otro elemento):
+    bool idDisponible(int id) const {
+        return idEnRango(id) && !existe(id);
+    }
+
+    // Registrar el elemento de la lista que corresponde al id. Devuelve false si el id no está disponible:
+    bool registrar(int id, typename list<T>::iterator it){
+        if (!idDisponible(id)){
+            return false;
+        }
+        if (id >= (int)posiciones.size()){
+            posiciones.resize(id + 1);
+            ocupado.resize(id + 1, false);
+        }
+        posiciones[id] = it;
+        ocupado[id] = true;
+        if (id >= siguiente_id){
+            siguiente_id = id + 1;
+        }
+        version++;
+        return true;
+    }
+
+    bool existe(int id) const {
+        return id > 0 && id < (int)ocupado.size() && ocupado[id];
+    }
+
+    // Obtener el elemento con el id indicado (se debe verificar antes con existe):
+    typename list<T>::iterator buscar(int id){
+        return posiciones[id];
+    }
+
+    // Liberar el id de un elemento eliminado:
+    void liberar(int id){
+        if (existe(id)){
+            ocupado[id] = false;
+            version++;
+        }
+    }
+
+    // Registrar un cambio hecho directamente sobre un elemento de la lista:
+    void marcarCambio(){
+        version++;
+    }
+};
+
+// ResumenCierre: Acumulados parciales del cierre de mes. Cada hilo llena su propio resumen, indexado por
+// el id del vendedor y del cliente y con un mapa propio de categorías, y al final se suman todos sin bloqueos.
+struct ResumenCierre {
+    int cantidad_ventas = 0;
+    vector<double> ventas_vendedor;
+    vector<int> cantidad_ventas_vendedor;
+    vector<double> ventas_cliente;
+    unordered_map<string, double> ventas_categoria;
+};
+
+// Constantes:
+// Porcentaje del total vendido que se paga como comisión a cada vendedor en el cierre de mes.
+const double TASA_COMISION = 0.05;
+// Cantidad de ventas (por número de venta) y de detalles que procesa cada tarea del cierre de mes.
+const int VENTAS_POR_TAREA = 4096;
+const int DETALLES_POR_TAREA = 16384;
+// Cantidad máxima de bytes que ocupan los resultados guardados en la caché de consultas.
+const size_t LIMITE_CACHE_BYTES = 4 * 1024 * 1024;
+
+// CacheConsultas: Caché de resultados de reportes, identificados por la consulta y sus parámetros. Cada
+// resultado se guarda con las versiones de las tablas de las que depende y deja de ser válido cuando
+// alguna de ellas cambia. Si se supera el límite de bytes se descartan los resultados usados hace más tiempo.
+struct CacheConsultas {
+    struct Entrada {
+        vector<long> versiones;
+        string resultado;
+        list<string>::iterator posicion_uso;
+    };
+    map<string, Entrada> entradas;
+    // Claves ordenadas desde la usada más recientemente:
+    list<string> orden_uso;
+    size_t bytes = 0;
+
+    bool buscar(const string &clave, const vector<long> &versiones, string &resultado){
+        map<string, Entrada>::iterator it = entradas.find(clave);
+        if (it == entradas.end()){
+            return false;
+        }
+        if (it->second.versiones != versiones){
+            eliminar(it);
+            return false;
+        }
+        orden_uso.splice(orden_uso.begin(), orden_uso, it->second.posicion_uso);
+        resultado = it->second.resultado;
+        return true;
+    }
+
+    void guardar(const string &clave, const vector<long> &versiones, const string &resultado){
+        size_t tamano = clave.size() + resultado.size();
+        map<string, Entrada>::iterator it = entradas.find(clave);
+        if (it != entradas.end()){
+            eliminar(it);
+        }
+        if (tamano > LIMITE_CACHE_BYTES){
+            return;
+        }
+        while (bytes + tamano > LIMITE_CACHE_BYTES){
+            eliminar(entradas.find(orden_uso.back()));
+        }
+        orden_uso.push_front(clave);
+        Entrada entrada;
+        entrada.versiones = versiones;
+        entrada.resultado = resultado;
+        entrada.posicion_uso = orden_uso.begin();
+        entradas[clave] = entrada;
+        bytes += tamano;
+    }
+
+    void eliminar(map<string, Entrada>::iterator it){
+        bytes -= it->first.size() + it->second.resultado.size();
+        orden_uso.erase(it->second.posicion_uso);
+        entradas.erase(it);
+    }
+};
+
+// Configuración de los resúmenes aproximados de ventas (sketches). Cambiarla invalida los resúmenes ya guardados.
+// HyperLogLog con 2^PRECISION_HLL registros: error relativo típico de 1.04 / sqrt(2^PRECISION_HLL), 3.25% con 10.
+const int PRECISION_HLL = 10;
+// Count-Min de ANCHO x PROFUNDIDAD: la cantidad estimada de un producto supera a la real en a lo más
+// e / ANCHO_COUNT_MIN del total vendido (0.1%), con probabilidad 1 - e^-PROFUNDIDAD_COUNT_MIN (99.3%).
+const int ANCHO_COUNT_MIN = 2719;
+const int PROFUNDIDAD_COUNT_MIN = 5;
+// Cantidad de productos más vendidos que se siguen en cada periodo.
+const int CANTIDAD_FRECUENTES = 10;
+
+// Mezclar los bits de un valor de 64 bits (finalizador de splitmix64):
+unsigned long long mezclarHash(unsigned long long x){
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// Hash de un texto (FNV-1a). No depende de la implementación de la biblioteca, de modo que los resúmenes
+// guardados en archivos siguen siendo válidos entre ejecuciones:
+unsigned long long hashTexto(const string &texto){
+    unsigned long long hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < texto.size(); i++){
+        hash ^= (unsigned char)texto[i];
+        hash *= 1099511628211ULL;
+    }
+    return mezclarHash(hash);
+}
+
+// HyperLogLog: Estimador de la cantidad de elementos distintos agregados, con memoria acotada. Mientras
+// tiene pocos registros distintos de cero los guarda dispersos, como (índice << 8) | valor ordenados por
+// índice, y pasa a los 2^PRECISION_HLL registros completos cuando la forma dispersa ocuparía más. Así un
+// producto o vendedor con pocos clientes en el mes ocupa unos pocos bytes en lugar de 2^PRECISION_HLL.
+struct HyperLogLog {
+    static const int REGISTROS = 1 << PRECISION_HLL;
+    static const int LIMITE_DISPERSO = REGISTROS / 4;
+    // Registros completos; vacío mientras se usa la forma dispersa:
+    vector<unsigned char> registros;
+    vector<unsigned int> disperso;
+
+    bool esDenso() const {
+        return !registros.empty();
+    }
+
+    void convertirDenso(){
+        registros.assign(REGISTROS, 0);
+        for (size_t i = 0; i < disperso.size(); i++){
+            registros[disperso[i] >> 8] = disperso[i] & 0xFF;
+        }
+        disperso.clear();
+        disperso.shrink_to_fit();
+    }
+
+    // Guardar el valor de un registro si es mayor que el actual:
+    void actualizar(int indice, unsigned char rango){
+        if (esDenso()){
+            if (rango > registros[indice]){
+                registros[indice] = rango;
+            }
+            return;
+        }
+        vector<unsigned int>::iterator it = lower_bound(disperso.begin(), disperso.end(), (unsigned int)indice << 8);
+        if (it != disperso.end() && (int)(*it >> 8) == indice){
+            if (rango > (*it & 0xFF)){
+                *it = ((unsigned int)indice << 8) | rango;
+            }
+            return;
+        }
+        disperso.insert(it, ((unsigned int)indice << 8) | rango);
+        if ((int)disperso.size() > LIMITE_DISPERSO){
+            convertirDenso();
+        }
+    }
+
+    void agregar(unsigned long long hash){
+        int indice = hash >> (64 - PRECISION_HLL);
+        unsigned long long resto = hash << PRECISION_HLL;
+        // Posición del primer bit en 1 de los bits restantes:
+        unsigned char rango = 1;
+        while (rango <= 64 - PRECISION_HLL && (resto & (1ULL << 63)) == 0){
+            rango++;
+            resto <<= 1;
+        }
+        actualizar(indice, rango);
+    }
+
+    double estimar() const {
+        int m = REGISTROS;
+        double suma = 0;
+        int ceros = 0;
+        if (esDenso()){
+            for (int i = 0; i < m; i++){
+                suma += ldexp(1.0, -registros[i]);
+                if (registros[i] == 0){
+                    ceros++;
+                }
+            }
+        } else {
+            // Los registros que no están en la forma dispersa valen 0 y suman 1 cada uno:
+            ceros = m - disperso.size();
+            suma = ceros;
+            for (size_t i = 0; i < disperso.size(); i++){
+                suma += ldexp(1.0, -(int)(disperso[i] & 0xFF));
+            }
+        }
+        double estimacion = 0.7213 / (1 + 1.079 / m) * m * m / suma;
+        // Corrección para cantidades pequeñas:
+        if (estimacion <= 2.5 * m && ceros > 0){
+            estimacion = m * log((double)m / ceros);
+        }
+        return estimacion;
+    }
+
+    void combinar(const HyperLogLog &otro){
+        if (otro.esDenso()){
+            if (!esDenso()){
+                convertirDenso();
+            }
+            for (int i = 0; i < REGISTROS; i++){
+                registros[i] = max(registros[i], otro.registros[i]);
+            }
+            return;
+        }
+        for (size_t i = 0; i < otro.disperso.size(); i++){
+            actualizar(otro.disperso[i] >> 8, otro.disperso[i] & 0xFF);
+        }
+    }
+};
+
+// CountMin: Estimador de la cantidad acumulada de cada clave, con memoria fija. Nunca subestima.
+struct CountMin {
+    vector<unsigned long long> contadores = vector<unsigned long long>(ANCHO_COUNT_MIN * PROFUNDIDAD_COUNT_MIN, 0);
+
+    int posicion(int fila, unsigned long long hash) const {
+        return fila * ANCHO_COUNT_MIN + mezclarHash(hash + fila) % ANCHO_COUNT_MIN;
+    }
+
+    void agregar(unsigned long long hash, long long cantidad){
+        for (int fila = 0; fila < PROFUNDIDAD_COUNT_MIN; fila++){
+            contadores[posicion(fila, hash)] += cantidad;
+        }
+    }
+
+    long long estimar(unsigned long long hash) const {
+        unsigned long long minimo = contadores[posicion(0, hash)];
+        for (int fila = 1; fila < PROFUNDIDAD_COUNT_MIN; fila++){
+            minimo = min(minimo, contadores[posicion(fila, hash)]);
+        }
+        return minimo;
+    }
+
+    void combinar(const CountMin &otro){
+        for (size_t i = 0; i < contadores.size(); i++){
+            contadores[i] += otro.contadores[i];
+        }
+    }
+};
+
+// SketchesVentas: Resúmenes aproximados de las ventas de un periodo: clientes distintos por producto y por
+// vendedor, y unidades vendidas por producto con un montículo de los CANTIDAD_FRECUENTES más vendidos.
+struct SketchesVentas {
+    map<string, HyperLogLog> clientes_producto;
+    map<int, HyperLogLog> clientes_vendedor;
+    CountMin unidades_producto;
+    // Montículo de mínimos (unidades estimadas, código), la raíz es el menos vendido de los seguidos:
+    vector<pair<long long, string>> frecuentes;
+
+    // Actualizar el montículo con la nueva estimación de un producto:
+    void actualizarFrecuente(const string &codigo, long long estimado){
+        for (size_t i = 0; i < frecuentes.size(); i++){
+            if (frecuentes[i].second == codigo){
+                frecuentes[i].first = estimado;
+                make_heap(frecuentes.begin(), frecuentes.end(), greater<pair<long long, string>>());
+                return;
+            }
+        }
+        if ((int)frecuentes.size() < CANTIDAD_FRECUENTES){
+            frecuentes.push_back(make_pair(estimado, codigo));
+            push_heap(frecuentes.begin(), frecuentes.end(), greater<pair<long long, string>>());
+        } else if (estimado > frecuentes.front().first){
+            pop_heap(frecuentes.begin(), frecuentes.end(), greater<pair<long long, string>>());
+            frecuentes.back() = make_pair(estimado, codigo);
+            push_heap(frecuentes.begin(), frecuentes.end(), greater<pair<long long, string>>());
+        }
+    }
+
+    void agregarVenta(const string &codigo, int id_cliente, int id_vendedor, int cantidad){
+        unsigned long long hash_cliente = mezclarHash(id_cliente);
+        clientes_producto[codigo].agregar(hash_cliente);
+        clientes_vendedor[id_vendedor].agregar(hash_cliente);
+        unsigned long long hash_codigo = hashTexto(codigo);
+        unidades_producto.agregar(hash_codigo, cantidad);
+        actualizarFrecuente(codigo, unidades_producto.estimar(hash_codigo));
+    }
+
+    // Sumar las unidades vendidas y los productos más vendidos de otro periodo:
+    void combinarUnidades(const SketchesVentas &otro){
+        unidades_producto.combinar(otro.unidades_producto);
+        // Volver a estimar los candidatos de ambos periodos con los contadores combinados:
+        set<string> candidatos;
+        for (size_t i = 0; i < frecuentes.size(); i++){
+            candidatos.insert(frecuentes[i].second);
+        }
+        for (size_t i = 0; i < otro.frecuentes.size(); i++){
+            candidatos.insert(otro.frecuentes[i].second);
+        }
+        frecuentes.clear();
+        for (set<string>::iterator it = candidatos.begin(); it != candidatos.end(); it++){
+            actualizarFrecuente(*it, unidades_producto.estimar(hashTexto(*it)));
+        }
+    }
+};
+
 // Variables globales:
 list<Producto> productos;
 map<string, Producto> productos_codigo;
@@ -112,40 +495,83 @@ list<Cliente> clientes;
 queue<Cliente> clientes_nuevos;
 stack<Cliente> clientes_pila;
 list<Venta> ventas;
-list<DetalleVenta> detalles_ventas;
+// Los detalles solo se agregan, así que se guardan en un vector que el cierre de mes divide en tramos:
+vector<DetalleVenta> detalles_ventas;
+TablaIds<Producto> tabla_productos;
+TablaIds<Cliente> tabla_clientes;
+TablaIds<Vendedor> tabla_vendedores;
+TablaIds<Venta> tabla_ventas;
+set<int> productos_stock_bajo;
+CacheConsultas cache_consultas;
+// Resúmenes aproximados de ventas por periodo (AAAA-MM):
+map<string, SketchesVentas> sketches_ventas;
+// Archivos con líneas que no se pudieron leer; no se sobrescriben al guardar para no perder su contenido:
+set<string> archivos_con_errores;
 
 
 
 // Definición de funciones:
 // Funciones para el manejo de productos:
-void agregarProducto(list<Producto> &productos, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria, queue<Proveedor> &proveedores);
-void modificarProducto(list<Producto> &productos, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria);
-void eliminarProducto(list<Producto> &productos, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria);
+void agregarProducto(list<Producto> &productos, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria, queue<Proveedor> &proveedores, TablaIds<Producto> &tabla_productos, set<int> &productos_stock_bajo);
+void modificarProducto(map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria, TablaIds<Producto> &tabla_productos, set<int> &productos_stock_bajo);
+void eliminarProducto(list<Producto> &productos, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria, TablaIds<Producto> &tabla_productos, set<int> &productos_stock_bajo);
 void mostrarProductos(list<Producto> &productos);
 
+// Funciones para las operaciones masivas sobre productos:
+FiltroOperacion convertirFiltro(const string &filtro);
+CambioOperacion convertirCambio(const string &cambio);
+bool textoEsEntero(const string &texto, int &valor);
+bool valorEsEntero(float valor);
+bool operacionMasivaValida(OperacionMasiva &operacion);
+int aplicarOperacionMasiva(list<Producto> &productos, OperacionMasiva &operacion, set<int> &productos_stock_bajo);
+void reconstruirIndicesProductos(list<Producto> &productos, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria);
+void operacionMasivaProductos(list<Producto> &productos, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria, TablaIds<Producto> &tabla_productos, set<int> &productos_stock_bajo);
+void cargarOperacionesMasivas(list<Producto> &productos, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria, TablaIds<Producto> &tabla_productos, set<int> &productos_stock_bajo);
+
+// Funciones para el control de stock bajo y los pedidos a proveedores:
+void actualizarStockBajo(set<int> &productos_stock_bajo, Producto &producto);
+void cambiarCantidadProducto(Producto &producto, int cantidad, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria, set<int> &productos_stock_bajo);
+void mostrarStockBajo(set<int> &productos_stock_bajo, TablaIds<Producto> &tabla_productos);
+void generarOrdenesCompra(set<int> &productos_stock_bajo, TablaIds<Producto> &tabla_productos, queue<Proveedor> &proveedores);
+
 // Funciones para el manejo de clientes:
-void agregarCliente(list<Cliente> &clientes);
+void agregarCliente(list<Cliente> &clientes, TablaIds<Cliente> &tabla_clientes);
 void mostrarClientes(list<Cliente> &clientes);
 void verificarClienteNuevo(queue<Cliente> &clientes_nuevos);
 void mostrarClienteNuevo(queue<Cliente> &clientes_nuevos);
 
 // Funciones para el manejo de ventas:
-void agregarVenta(list<Venta> &ventas, list<DetalleVenta> &detalles_ventas, list<Producto> &productos, list<Cliente> &clientes, list<Vendedor> &vendedores);
-void mostrarVentas(list<Venta> &ventas, list<DetalleVenta> &detalles_ventas);
-void mostrarDetalleVenta(list<DetalleVenta> &detalles_ventas);
-void actualizarMontoTotal(list<Cliente> &clientes, list<Venta> &ventas);
+bool periodoValido(const string &periodo);
+bool fechaValida(const string &fecha);
+void agregarVenta(list<Venta> &ventas, vector<DetalleVenta> &detalles_ventas, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria, TablaIds<Producto> &tabla_productos, set<int> &productos_stock_bajo, TablaIds<Cliente> &tabla_clientes, TablaIds<Vendedor> &tabla_vendedores, TablaIds<Venta> &tabla_ventas, map<string, SketchesVentas> &sketches_ventas);
+void mostrarVentas(list<Venta> &ventas, vector<DetalleVenta> &detalles_ventas, TablaIds<Venta> &tabla_ventas, CacheConsultas &cache_consultas);
+void mostrarDetalleVenta(vector<DetalleVenta> &detalles_ventas);
+void mostrarTableroAproximado(map<string, SketchesVentas> &sketches_ventas, TablaIds<Vendedor> &tabla_vendedores);
+void actualizarMontoTotal(list<Cliente> &clientes, list<Venta> &ventas, TablaIds<Cliente> &tabla_clientes, TablaIds<Venta> &tabla_ventas, CacheConsultas &cache_consultas);
+
+// Funciones para el cierre de mes:
+void ejecutarTareasEnParalelo(vector<function<void(int)>> &tareas, int num_hilos);
+void cierreMes(vector<DetalleVenta> &detalles_ventas, TablaIds<Cliente> &tabla_clientes, TablaIds<Vendedor> &tabla_vendedores, TablaIds<Venta> &tabla_ventas, CacheConsultas &cache_consultas);
 
 // Funciones para el manejo de vendedores:
-void agregarVendedor(list<Vendedor> &vendedores);
+void agregarVendedor(list<Vendedor> &vendedores, TablaIds<Vendedor> &tabla_vendedores);
 void mostrarVendedores(list<Vendedor> &vendedores);
 void verificarVendedorNuevo(queue<Vendedor> &vendedores_nuevos);
 void mostrarVendedorNuevo(queue<Vendedor> &vendedores_nuevos);
 
+// Funciones auxiliares para leer y escribir los archivos:
+int contarCampos(const string &linea);
+void registrarLineaNoValida(set<string> &archivos_con_errores, const string &nombre_archivo, const string &linea);
+bool puedeGuardarArchivo(set<string> &archivos_con_errores, const string &nombre_archivo);
+void escribirHll(ostream &archivo, const HyperLogLog &hll);
+bool leerHll(istream &archivo, HyperLogLog &hll);
+bool leerSketchesPeriodo(istream &archivo, SketchesVentas &sketches);
+
 // Función para cargar la información de los archivos:
-void cargarInformacion(list<Producto> &productos, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria, list<Cliente> &clientes, list<Venta> &ventas, list<Vendedor> &vendedores, queue<Proveedor> &proveedores);
+void cargarInformacion(list<Producto> &productos, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria, list<Cliente> &clientes, list<Venta> &ventas, vector<DetalleVenta> &detalles_ventas, list<Vendedor> &vendedores, queue<Proveedor> &proveedores, TablaIds<Producto> &tabla_productos, TablaIds<Cliente> &tabla_clientes, TablaIds<Vendedor> &tabla_vendedores, TablaIds<Venta> &tabla_ventas, set<int> &productos_stock_bajo, map<string, SketchesVentas> &sketches_ventas, set<string> &archivos_con_errores);
 
 // Función para guardar la información en archivos:
-void guardarInformacion(list<Producto> &productos, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria, list<Cliente> &clientes, list<Venta> &ventas, list<Vendedor> &vendedores, queue<Proveedor> &proveedores);
+void guardarInformacion(list<Producto> &productos, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria, list<Cliente> &clientes, list<Venta> &ventas, vector<DetalleVenta> &detalles_ventas, list<Vendedor> &vendedores, queue<Proveedor> &proveedores, TablaIds<Producto> &tabla_productos, TablaIds<Cliente> &tabla_clientes, TablaIds<Vendedor> &tabla_vendedores, TablaIds<Venta> &tabla_ventas, map<string, SketchesVentas> &sketches_ventas, set<string> &archivos_con_errores);
 
 // Función para mostrar el menú principal de opciones:
 void mostrarMenuPrincipal();
@@ -170,7 +596,7 @@ int main()
     system("cls");
 
     // Cargar la información de los archivos:
-    cargarInformacion(productos, productos_codigo, productos_categoria, clientes, ventas, vendedores, proveedores);
+    cargarInformacion(productos, productos_codigo, productos_categoria, clientes, ventas, detalles_ventas, vendedores, proveedores, tabla_productos, tabla_clientes, tabla_vendedores, tabla_ventas, productos_stock_bajo, sketches_ventas, archivos_con_errores);
 
     do {
         mostrarMenuPrincipal();
@@ -183,7 +609,7 @@ int main()
                 system("cls");
                 switch (opcion2){
                     case 1:
-                        agregarVendedor(vendedores);
+                        agregarVendedor(vendedores, tabla_vendedores);
                         break;
                     case 2:
                         mostrarVendedores(vendedores);
@@ -207,17 +633,29 @@ int main()
                 system("cls");
                 switch (opcion2){
                     case 1:
-                        agregarProducto(productos, productos_codigo, productos_categoria, proveedores);
+                        agregarProducto(productos, productos_codigo, productos_categoria, proveedores, tabla_productos, productos_stock_bajo);
                         break;
                     case 2:
-                        modificarProducto(productos, productos_codigo, productos_categoria);
+                        modificarProducto(productos_codigo, productos_categoria, tabla_productos, productos_stock_bajo);
                         break;
                     case 3:
-                        eliminarProducto(productos, productos_codigo, productos_categoria);
+                        eliminarProducto(productos, productos_codigo, productos_categoria, tabla_productos, productos_stock_bajo);
                         break;
                     case 4:
                         mostrarProductos(productos);
                         break;
+                    case 5:
+                        operacionMasivaProductos(productos, productos_codigo, productos_categoria, tabla_productos, productos_stock_bajo);
+                        break;
+                    case 6:
+                        cargarOperacionesMasivas(productos, productos_codigo, productos_categoria, tabla_productos, productos_stock_bajo);
+                        break;
+                    case 7:
+                        mostrarStockBajo(productos_stock_bajo, tabla_productos);
+                        break;
+                    case 8:
+                        generarOrdenesCompra(productos_stock_bajo, tabla_productos, proveedores);
+                        break;
                     case 0:
                         break;
                     default:
@@ -231,14 +669,17 @@ int main()
                 system("cls");
                 switch (opcion2){
                     case 1:
-                        agregarVenta(ventas, detalles_ventas, productos, clientes, vendedores);
+                        agregarVenta(ventas, detalles_ventas, productos_codigo, productos_categoria, tabla_productos, productos_stock_bajo, tabla_clientes, tabla_vendedores, tabla_ventas, sketches_ventas);
                         break;
                     case 2:
-                        mostrarVentas(ventas, detalles_ventas);
+                        mostrarVentas(ventas, detalles_ventas, tabla_ventas, cache_consultas);
                         break;
                     case 3:
                         mostrarDetalleVenta(detalles_ventas);
                         break;
+                    case 4:
+                        mostrarTableroAproximado(sketches_ventas, tabla_vendedores);
+                        break;
                     case 0:
                         break;
                     default:
@@ -252,7 +693,7 @@ int main()
                 system("cls");
                 switch (opcion2){
                     case 1:
-                        agregarCliente(clientes);
+                        agregarCliente(clientes, tabla_clientes);
                         break;
                     case 2:
                         mostrarClientes(clientes);
@@ -264,7 +705,7 @@ int main()
                         mostrarClienteNuevo(clientes_nuevos);
                         break;
                     case 5:
-                        actualizarMontoTotal(clientes, ventas);
+                        actualizarMontoTotal(clientes, ventas, tabla_clientes, tabla_ventas, cache_consultas);
                         break;
                     case 0:
                         break;
@@ -274,7 +715,10 @@ int main()
                 }
                 break;
             case 5:
-                mostrarVentas(ventas, detalles_ventas);
+                mostrarVentas(ventas, detalles_ventas, tabla_ventas, cache_consultas);
+                break;
+            case 6:
+                cierreMes(detalles_ventas, tabla_clientes, tabla_vendedores, tabla_ventas, cache_consultas);
                 break;
             case 0:
                 break;
@@ -285,14 +729,14 @@ int main()
     } while (opcion != 0);
 
     // Guardar la información en los archivos:
-    guardarInformacion(productos, productos_codigo, productos_categoria, clientes, ventas, vendedores, proveedores);
+    guardarInformacion(productos, productos_codigo, productos_categoria, clientes, ventas, detalles_ventas, vendedores, proveedores, tabla_productos, tabla_clientes, tabla_vendedores, tabla_ventas, sketches_ventas, archivos_con_errores);
 
     
     return 0;
 }
 
 // Implementación de funciones:
-void agregarProducto(list<Producto> &productos, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria, queue<Proveedor> &proveedores){
+void agregarProducto(list<Producto> &productos, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria, queue<Proveedor> &proveedores, TablaIds<Producto> &tabla_productos, set<int> &productos_stock_bajo){
     Producto producto;
 
     // Ingresar la información del producto y corregir el error de ingreso de datos:
@@ -316,6 +760,8 @@ void agregarProducto(list<Producto> &productos, map<string, Producto> &productos
     cin >> producto.precio;
     cout << "Ingrese la cantidad del producto: ";
     cin >> producto.cantidad;
+    cout << "Ingrese el stock mínimo del producto: ";
+    cin >> producto.stock_minimo;
     //cin.ignore();
     cout << "Ingrese la descripción del producto: ";
     getline(cin, producto.descripcion);
@@ -327,39 +773,59 @@ void agregarProducto(list<Producto> &productos, map<string, Producto> &productos
     cout << "Ingrese el estado del producto: ";
     cin >> producto.estado;
 
-    cout << "Ingrese el id del proveedor: ";
-
+    // Obtener los proveedores por id recorriendo la cola una sola vez:
+    map<int, Proveedor> proveedores_id;
+    queue<Proveedor> proveedores_aux = proveedores;
+    while (!proveedores_aux.empty()){
+        proveedores_id[proveedores_aux.front().id] = proveedores_aux.front();
+        proveedores_aux.pop();
+    }
+    // Pedir el id hasta que sea un proveedor existente, o 0 si el producto no tiene proveedor:
+    cout << "Ingrese el id del proveedor (0 si no tiene): ";
     int id_proveedor;
-    cin >> id_proveedor;
-    queue<Proveedor> proveedores_aux;
-    Proveedor proveedor;
-    while (!proveedores.empty()){
-        proveedor = proveedores.front();
-        proveedores.pop();
-        if (proveedor.id == id_proveedor){
-            producto.proveedor = proveedor;
+    while (true){
+        cin >> id_proveedor;
+        if (cin.eof()){
+            return;
+        }
+        if (cin.fail()){
+            cin.clear();
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        } else if (id_proveedor == 0){
+            // El nombre "-" mantiene la cantidad de campos de la línea en productos.txt:
+            producto.proveedor.id = 0;
+            producto.proveedor.nombre = "-";
+            break;
+        } else if (proveedores_id.count(id_proveedor)){
+            producto.proveedor = proveedores_id[id_proveedor];
+            break;
         }
-        proveedores_aux.push(proveedor);
+        cout << "El proveedor no existe. Ingrese el id del proveedor (0 si no tiene): ";
     }
-    proveedores = proveedores_aux;
+    producto.id = tabla_productos.asignarId();
     productos.push_back(producto);
+    tabla_productos.registrar(producto.id, prev(productos.end()));
     productos_codigo[producto.codigo] = producto;
     productos_categoria[producto.categoria].push_back(producto);
+    actualizarStockBajo(productos_stock_bajo, producto);
 }
 
-void modificarProducto(list<Producto> &productos, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria){
+void modificarProducto(map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria, TablaIds<Producto> &tabla_productos, set<int> &productos_stock_bajo){
     string codigo;
     cout << "Ingrese el código del producto a modificar: ";
     cin >> codigo;
     map<string, Producto>::iterator it = productos_codigo.find(codigo);
     if (it != productos_codigo.end()){
         Producto producto = it->second;
+        string categoria_anterior = producto.categoria;
         cout << "Ingrese el nuevo nombre del producto: ";
         cin >> producto.nombre;
         cout << "Ingrese el nuevo precio del producto: ";
         cin >> producto.precio;
         cout << "Ingrese la nueva cantidad del producto: ";
         cin >> producto.cantidad;
+        cout << "Ingrese el nuevo stock mínimo del producto: ";
+        cin >> producto.stock_minimo;
         cout << "Ingrese la nueva descripción del producto: ";
         cin >> producto.descripcion;
         cout << "Ingrese la nueva categoría del producto: ";
@@ -367,36 +833,30 @@ void modificarProducto(list<Producto> &productos, map<string, Producto> &product
         cout << "Ingrese el nuevo estado del producto: ";
         cin >> producto.estado;
         productos_codigo[codigo] = producto;
-        list<Producto> productos_aux;
-        for (list<Producto>::iterator it = productos.begin(); it != productos.end(); it++){
-            if (it->codigo == codigo){
-                productos_aux.push_back(producto);
-            } else {
-                productos_aux.push_back(*it);
-            }
-        }
-        productos = productos_aux;
-        list<Producto> productos_categoria_aux;
-        for (map<string, list<Producto>>::iterator it = productos_categoria.begin(); it != productos_categoria.end(); it++){
-            if (it->first == producto.categoria){
-                for (list<Producto>::iterator it2 = it->second.begin(); it2 != it->second.end(); it2++){
-                    if (it2->codigo == codigo){
-                        productos_categoria_aux.push_back(producto);
-                    } else {
-                        productos_categoria_aux.push_back(*it2);
-                    }
+        // Actualizar el producto en su lugar de la lista, accediendo directamente por su id:
+        *tabla_productos.buscar(producto.id) = producto;
+        tabla_productos.marcarCambio();
+        actualizarStockBajo(productos_stock_bajo, producto);
+        // Actualizar el producto en la lista de su categoría, moviéndolo si cambió de categoría:
+        list<Producto> &categoria = productos_categoria[categoria_anterior];
+        if (categoria_anterior == producto.categoria){
+            for (list<Producto>::iterator it2 = categoria.begin(); it2 != categoria.end(); it2++){
+                if (it2->codigo == codigo){
+                    *it2 = producto;
                 }
-            } else {
-                productos_categoria_aux = it->second;
             }
+        } else {
+            categoria.remove_if([codigo](const Producto &p){
+                return p.codigo == codigo;
+            });
+            productos_categoria[producto.categoria].push_back(producto);
         }
-        productos_categoria[producto.categoria] = productos_categoria_aux;
     } else {
         cout << "El producto no existe." << endl;
     }
 }
 
-void eliminarProducto(list<Producto> &productos, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria){
+void eliminarProducto(list<Producto> &productos, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria, TablaIds<Producto> &tabla_productos, set<int> &productos_stock_bajo){
     string codigo;
     cout << "Ingrese el código del producto a eliminar: ";
     cin >> codigo;
@@ -404,26 +864,13 @@ void eliminarProducto(list<Producto> &productos, map<string, Producto> &producto
     if (it != productos_codigo.end()){
         Producto producto = it->second;
         productos_codigo.erase(codigo);
-        list<Producto> productos_aux;
-        for (list<Producto>::iterator it = productos.begin(); it != productos.end(); it++){
-            if (it->codigo != codigo){
-                productos_aux.push_back(*it);
-            }
-        }
-        productos = productos_aux;
-        list<Producto> productos_categoria_aux;
-        for (map<string, list<Producto>>::iterator it = productos_categoria.begin(); it != productos_categoria.end(); it++){
-            if (it->first == producto.categoria){
-                for (list<Producto>::iterator it2 = it->second.begin(); it2 != it->second.end(); it2++){
-                    if (it2->codigo != codigo){
-                        productos_categoria_aux.push_back(*it2);
-                    }
-                }
-            } else {
-                productos_categoria_aux = it->second;
-            }
-        }
-        productos_categoria[producto.categoria] = productos_categoria_aux;
+        // Quitar el producto de la lista accediendo directamente por su id y liberar el id:
+        productos.erase(tabla_productos.buscar(producto.id));
+        tabla_productos.liberar(producto.id);
+        productos_stock_bajo.erase(producto.id);
+        productos_categoria[producto.categoria].remove_if([codigo](const Producto &p){
+            return p.codigo == codigo;
+        });
     } else {
         cout << "El producto no existe." << endl;
     }
@@ -432,10 +879,12 @@ void eliminarProducto(list<Producto> &productos, map<string, Producto> &producto
 void mostrarProductos(list<Producto> &productos){
     for (list<Producto>::iterator it = productos.begin(); it != productos.end(); it++){
         cout << "------------------------------------------" << endl;
+        cout << "ID: " << it->id << endl;
         cout << "Código: " << it->codigo << endl;
         cout << "Nombre: " << it->nombre << endl;
         cout << "Precio: " << it->precio << endl;
         cout << "Cantidad: " << it->cantidad << endl;
+        cout << "Stock mínimo: " << it->stock_minimo << endl;
         cout << "Descripción: " << it->descripcion << endl;
         cout << "Categoría: " << it->categoria << endl;
         cout << "Proveedor: " << it->proveedor.nombre << endl;
@@ -445,7 +894,313 @@ void mostrarProductos(list<Producto> &productos){
     }
 }
 
-void agregarCliente(list<Cliente> &clientes){
+FiltroOperacion convertirFiltro(const string &filtro){
+    if (filtro == "todos"){
+        return FILTRO_TODOS;
+    }
+    if (filtro == "categoria"){
+        return FILTRO_CATEGORIA;
+    }
+    if (filtro == "proveedor"){
+        return FILTRO_PROVEEDOR;
+    }
+    if (filtro == "stock_menor"){
+        return FILTRO_STOCK_MENOR;
+    }
+    if (filtro == "estado"){
+        return FILTRO_ESTADO;
+    }
+    return FILTRO_NO_VALIDO;
+}
+
+CambioOperacion convertirCambio(const string &cambio){
+    if (cambio == "precio_porcentaje"){
+        return CAMBIO_PRECIO_PORCENTAJE;
+    }
+    if (cambio == "precio"){
+        return CAMBIO_PRECIO;
+    }
+    if (cambio == "cantidad_sumar"){
+        return CAMBIO_CANTIDAD_SUMAR;
+    }
+    if (cambio == "cantidad"){
+        return CAMBIO_CANTIDAD;
+    }
+    if (cambio == "estado"){
+        return CAMBIO_ESTADO;
+    }
+    return CAMBIO_NO_VALIDO;
+}
+
+// Convertir un texto a entero. Devuelve false si no es un número entero o no cabe en un int:
+bool textoEsEntero(const string &texto, int &valor){
+    istringstream entrada(texto);
+    long long numero;
+    if (!(entrada >> numero) || !(entrada >> ws).eof() || numero < numeric_limits<int>::min() || numero > numeric_limits<int>::max()){
+        return false;
+    }
+    valor = numero;
+    return true;
+}
+
+// Indicar si un valor leído como número es entero y cabe en un int:
+bool valorEsEntero(float valor){
+    return valor == floor(valor) && (double)valor >= numeric_limits<int>::min() && (double)valor <= numeric_limits<int>::max();
+}
+
+// La operación es válida si el filtro y el cambio existen, sus valores tienen el tipo que esperan y el
+// cambio no deja precios negativos:
+bool operacionMasivaValida(OperacionMasiva &operacion){
+    FiltroOperacion filtro = convertirFiltro(operacion.filtro);
+    CambioOperacion cambio = convertirCambio(operacion.cambio);
+    if (filtro == FILTRO_NO_VALIDO || cambio == CAMBIO_NO_VALIDO){
+        return false;
+    }
+    int stock_limite;
+    if (filtro == FILTRO_STOCK_MENOR && !textoEsEntero(operacion.valor_filtro, stock_limite)){
+        return false;
+    }
+    if (filtro == FILTRO_ESTADO && operacion.valor_filtro != "0" && operacion.valor_filtro != "1"){
+        return false;
+    }
+    if ((cambio == CAMBIO_CANTIDAD || cambio == CAMBIO_CANTIDAD_SUMAR) && !valorEsEntero(operacion.valor_cambio)){
+        return false;
+    }
+    if (cambio == CAMBIO_ESTADO && operacion.valor_cambio != 0 && operacion.valor_cambio != 1){
+        return false;
+    }
+    if (cambio == CAMBIO_PRECIO && operacion.valor_cambio < 0){
+        return false;
+    }
+    if (cambio == CAMBIO_PRECIO_PORCENTAJE && operacion.valor_cambio < -100){
+        return false;
+    }
+    return true;
+}
+
+// Aplicar la operación a todos los productos que cumplan el filtro en un solo recorrido de la lista.
+// Los índices por código y por categoría no se actualizan aquí, sino una sola vez al terminar.
+int aplicarOperacionMasiva(list<Producto> &productos, OperacionMasiva &operacion, set<int> &productos_stock_bajo){
+    // Convertir el filtro, el cambio y el valor del filtro una sola vez, antes del recorrido:
+    FiltroOperacion filtro = convertirFiltro(operacion.filtro);
+    CambioOperacion cambio = convertirCambio(operacion.cambio);
+    int stock_limite = 0;
+    bool estado_filtro = false;
+    if (filtro == FILTRO_STOCK_MENOR){
+        textoEsEntero(operacion.valor_filtro, stock_limite);
+    } else if (filtro == FILTRO_ESTADO){
+        estado_filtro = operacion.valor_filtro == "1";
+    }
+    float factor = 1 + operacion.valor_cambio / 100;
+    long long cantidad_cambio = (long long)operacion.valor_cambio;
+    int modificados = 0;
+    for (list<Producto>::iterator it = productos.begin(); it != productos.end(); it++){
+        bool cumple;
+        switch (filtro){
+            case FILTRO_CATEGORIA:
+                cumple = it->categoria == operacion.valor_filtro;
+                break;
+            case FILTRO_PROVEEDOR:
+                cumple = it->proveedor.nombre == operacion.valor_filtro;
+                break;
+            case FILTRO_STOCK_MENOR:
+                cumple = it->cantidad < stock_limite;
+                break;
+            case FILTRO_ESTADO:
+                cumple = it->estado == estado_filtro;
+                break;
+            default:
+                cumple = true;
+                break;
+        }
+        if (!cumple){
+            continue;
+        }
+        switch (cambio){
+            case CAMBIO_PRECIO_PORCENTAJE:
+                it->precio = it->precio * factor;
+                break;
+            case CAMBIO_PRECIO:
+                it->precio = operacion.valor_cambio;
+                break;
+            case CAMBIO_CANTIDAD_SUMAR:
+                // Sumar en long long para que la cantidad no se desborde:
+                it->cantidad = (int)min((long long)numeric_limits<int>::max(), max(0LL, it->cantidad + cantidad_cambio));
+                break;
+            case CAMBIO_CANTIDAD:
+                it->cantidad = (int)max(0LL, cantidad_cambio);
+                break;
+            default:
+                it->estado = operacion.valor_cambio != 0;
+                break;
+        }
+        actualizarStockBajo(productos_stock_bajo, *it);
+        modificados++;
+    }
+    return modificados;
+}
+
+void reconstruirIndicesProductos(list<Producto> &productos, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria){
+    productos_codigo.clear();
+    productos_categoria.clear();
+    for (list<Producto>::iterator it = productos.begin(); it != productos.end(); it++){
+        productos_codigo[it->codigo] = *it;
+        productos_categoria[it->categoria].push_back(*it);
+    }
+}
+
+void operacionMasivaProductos(list<Producto> &productos, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria, TablaIds<Producto> &tabla_productos, set<int> &productos_stock_bajo){
+    OperacionMasiva operacion;
+    cout << "Ingrese el filtro (todos, categoria, proveedor, stock_menor, estado): ";
+    cin >> operacion.filtro;
+    if (operacion.filtro != "todos"){
+        cout << "Ingrese el valor del filtro: ";
+        cin >> operacion.valor_filtro;
+    }
+    cout << "Ingrese el cambio (precio_porcentaje, precio, cantidad_sumar, cantidad, estado): ";
+    cin >> operacion.cambio;
+    cout << "Ingrese el valor del cambio: ";
+    cin >> operacion.valor_cambio;
+    if (cin.fail()){
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "Operación no válida." << endl;
+        return;
+    }
+    if (!operacionMasivaValida(operacion)){
+        cout << "Operación no válida." << endl;
+        return;
+    }
+    int modificados = aplicarOperacionMasiva(productos, operacion, productos_stock_bajo);
+    reconstruirIndicesProductos(productos, productos_codigo, productos_categoria);
+    tabla_productos.marcarCambio();
+    cout << "Productos modificados: " << modificados << endl;
+}
+
+// Cargar y aplicar las operaciones de un archivo, con una operación por línea en el formato:
+// <filtro> <valor_filtro> <cambio> <valor_cambio>   (para el filtro "todos" el valor del filtro es "-")
+void cargarOperacionesMasivas(list<Producto> &productos, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria, TablaIds<Producto> &tabla_productos, set<int> &productos_stock_bajo){
+    string nombre_archivo;
+    cout << "Ingrese el nombre del archivo de operaciones: ";
+    cin >> nombre_archivo;
+    ifstream archivo_operaciones(nombre_archivo);
+    if (!archivo_operaciones.is_open()){
+        cout << "No se pudo abrir el archivo." << endl;
+        return;
+    }
+    // Leer línea por línea, para informar y saltar las líneas mal escritas sin perder el resto del archivo:
+    string linea;
+    int numero_linea = 0;
+    int aplicadas = 0;
+    int modificados = 0;
+    while (getline(archivo_operaciones, linea)){
+        numero_linea++;
+        int campos = contarCampos(linea);
+        if (campos == 0){
+            continue;
+        }
+        istringstream entrada(linea);
+        OperacionMasiva operacion;
+        bool leido = campos == 4 && (bool)(entrada >> operacion.filtro >> operacion.valor_filtro >> operacion.cambio >> operacion.valor_cambio) && (entrada >> ws).eof();
+        if (!leido || !operacionMasivaValida(operacion)){
+            cout << "Operación no válida en la línea " << numero_linea << ": " << linea << endl;
+            continue;
+        }
+        modificados += aplicarOperacionMasiva(productos, operacion, productos_stock_bajo);
+        aplicadas++;
+    }
+    archivo_operaciones.close();
+    // Actualizar los índices una sola vez para todas las operaciones del archivo:
+    reconstruirIndicesProductos(productos, productos_codigo, productos_categoria);
+    tabla_productos.marcarCambio();
+    cout << "Operaciones aplicadas: " << aplicadas << endl;
+    cout << "Productos modificados: " << modificados << endl;
+}
+
+// Marcar o desmarcar el producto como stock bajo según su cantidad actual. Se llama cada vez que cambia
+// la cantidad o el estado de un producto, de modo que consultar los productos a pedir solo recorre los
+// marcados. Los productos inactivos no se marcan, porque no se vuelven a pedir.
+void actualizarStockBajo(set<int> &productos_stock_bajo, Producto &producto){
+    if (producto.estado && producto.cantidad <= producto.stock_minimo){
+        productos_stock_bajo.insert(producto.id);
+    } else {
+        productos_stock_bajo.erase(producto.id);
+    }
+}
+
+// Cambiar la cantidad de un producto de la lista, actualizando sus copias en los índices:
+void cambiarCantidadProducto(Producto &producto, int cantidad, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria, set<int> &productos_stock_bajo){
+    producto.cantidad = cantidad;
+    productos_codigo[producto.codigo].cantidad = cantidad;
+    list<Producto> &categoria = productos_categoria[producto.categoria];
+    for (list<Producto>::iterator it = categoria.begin(); it != categoria.end(); it++){
+        if (it->codigo == producto.codigo){
+            it->cantidad = cantidad;
+        }
+    }
+    actualizarStockBajo(productos_stock_bajo, producto);
+}
+
+void mostrarStockBajo(set<int> &productos_stock_bajo, TablaIds<Producto> &tabla_productos){
+    if (productos_stock_bajo.empty()){
+        cout << "No hay productos con stock bajo." << endl;
+        return;
+    }
+    for (set<int>::iterator it = productos_stock_bajo.begin(); it != productos_stock_bajo.end(); it++){
+        Producto &producto = *tabla_productos.buscar(*it);
+        cout << "Código: " << producto.codigo << endl;
+        cout << "Nombre: " << producto.nombre << endl;
+        cout << "Cantidad: " << producto.cantidad << endl;
+        cout << "Stock mínimo: " << producto.stock_minimo << endl;
+        cout << "Proveedor: " << producto.proveedor.nombre << endl;
+        cout << endl;
+    }
+}
+
+// Generar una orden de compra por proveedor con los productos de stock bajo. Para cada producto se
+// pide lo necesario para llegar al doble de su stock mínimo. Las órdenes se guardan en ordenes_compra.txt.
+void generarOrdenesCompra(set<int> &productos_stock_bajo, TablaIds<Producto> &tabla_productos, queue<Proveedor> &proveedores){
+    if (productos_stock_bajo.empty()){
+        cout << "No hay productos con stock bajo." << endl;
+        return;
+    }
+    // Agrupar los productos marcados por el id de su proveedor:
+    map<int, list<Producto>> pedidos;
+    for (set<int>::iterator it = productos_stock_bajo.begin(); it != productos_stock_bajo.end(); it++){
+        Producto &producto = *tabla_productos.buscar(*it);
+        pedidos[producto.proveedor.id].push_back(producto);
+    }
+    // Obtener los datos de los proveedores recorriendo la cola una sola vez:
+    map<int, Proveedor> proveedores_id;
+    queue<Proveedor> proveedores_aux = proveedores;
+    while (!proveedores_aux.empty()){
+        proveedores_id[proveedores_aux.front().id] = proveedores_aux.front();
+        proveedores_aux.pop();
+    }
+    ofstream archivo_ordenes("ordenes_compra.txt");
+    for (map<int, list<Producto>>::iterator it = pedidos.begin(); it != pedidos.end(); it++){
+        stringstream orden;
+        map<int, Proveedor>::iterator it2 = proveedores_id.find(it->first);
+        if (it2 != proveedores_id.end()){
+            orden << "Orden de compra para el proveedor " << it2->second.id << " " << it2->second.nombre << " (" << it2->second.correo << ")" << endl;
+        } else {
+            orden << "Orden de compra sin proveedor asignado" << endl;
+        }
+        for (list<Producto>::iterator it3 = it->second.begin(); it3 != it->second.end(); it3++){
+            int cantidad_pedir = 2 * it3->stock_minimo - it3->cantidad;
+            if (cantidad_pedir < 1){
+                cantidad_pedir = 1;
+            }
+            orden << "  " << it3->codigo << " " << it3->nombre << " cantidad: " << cantidad_pedir << endl;
+        }
+        cout << orden.str() << endl;
+        archivo_ordenes << orden.str() << endl;
+    }
+    archivo_ordenes.close();
+    cout << "Órdenes de compra generadas: " << pedidos.size() << endl;
+}
+
+void agregarCliente(list<Cliente> &clientes, TablaIds<Cliente> &tabla_clientes){
     Cliente cliente;
     cout << "Ingrese el nombre del cliente: ";
     cin >> cliente.nombre;
@@ -459,11 +1214,15 @@ void agregarCliente(list<Cliente> &clientes){
     cin >> cliente.direccion;
     cout << "Ingrese el NIT del cliente: ";
     cin >> cliente.nit;
+    cliente.id = tabla_clientes.asignarId();
     clientes.push_back(cliente);
+    tabla_clientes.registrar(cliente.id, prev(clientes.end()));
+    cout << "Cliente registrado con el id " << cliente.id << "." << endl;
 }
 
 void mostrarClientes(list<Cliente> &clientes){
     for (list<Cliente>::iterator it = clientes.begin(); it != clientes.end(); it++){
+        cout << "ID: " << it->id << endl;
         cout << "Nombre: " << it->nombre << endl;
         cout << "Apellido: " << it->apellido << endl;
         cout << "Teléfono: " << it->telefono << endl;
@@ -496,100 +1255,206 @@ void mostrarClienteNuevo(queue<Cliente> &clientes_nuevos){
     }
 }
 
-void actualizarMontoTotal(list<Cliente> &clientes, list<Venta> &ventas){
-    for (list<Cliente>::iterator it = clientes.begin(); it != clientes.end(); it++){
-        float total = 0;
-        for (list<Venta>::iterator it2 = ventas.begin(); it2 != ventas.end(); it2++){
-            if (it->id == it2->cliente.id){
-                total += it2->total;
+void actualizarMontoTotal(list<Cliente> &clientes, list<Venta> &ventas, TablaIds<Cliente> &tabla_clientes, TablaIds<Venta> &tabla_ventas, CacheConsultas &cache_consultas){
+    // Usar el resultado anterior si no cambiaron los clientes ni las ventas:
+    vector<long> versiones = {tabla_clientes.version, tabla_ventas.version};
+    string resultado;
+    if (!cache_consultas.buscar("monto_total", versiones, resultado)){
+        // Acumular los montos en un solo recorrido de las ventas, usando el id del cliente como índice:
+        vector<float> totales(tabla_clientes.siguiente_id, 0);
+        for (list<Venta>::iterator it = ventas.begin(); it != ventas.end(); it++){
+            if (tabla_clientes.existe(it->cliente.id)){
+                totales[it->cliente.id] += it->total;
             }
         }
-        cout << "Cliente: " << it->nombre << " " << it->apellido << endl;
-        cout << "Monto total: " << total << endl;
+        stringstream salida;
+        for (list<Cliente>::iterator it = clientes.begin(); it != clientes.end(); it++){
+            salida << "Cliente: " << it->nombre << " " << it->apellido << endl;
+            salida << "Monto total: " << totales[it->id] << endl;
+        }
+        resultado = salida.str();
+        cache_consultas.guardar("monto_total", versiones, resultado);
     }
+    cout << resultado;
 }
 
-void agregarVenta(list<Venta> &ventas, list<DetalleVenta> &detalles_ventas, list<Producto> &productos, list<Cliente> &clientes, list<Vendedor> &vendedores){
+// Verificar que el periodo tenga el formato AAAA-MM:
+bool periodoValido(const string &periodo){
+    if (periodo.size() != 7 || periodo[4] != '-'){
+        return false;
+    }
+    for (int i = 0; i < 7; i++){
+        if (i != 4 && !isdigit((unsigned char)periodo[i])){
+            return false;
+        }
+    }
+    int mes = atoi(periodo.substr(5, 2).c_str());
+    return mes >= 1 && mes <= 12;
+}
+
+// Verificar que la fecha tenga el formato AAAA-MM-DD:
+bool fechaValida(const string &fecha){
+    if (fecha.size() != 10 || fecha[7] != '-' || !periodoValido(fecha.substr(0, 7))){
+        return false;
+    }
+    if (!isdigit((unsigned char)fecha[8]) || !isdigit((unsigned char)fecha[9])){
+        return false;
+    }
+    int dia = atoi(fecha.substr(8, 2).c_str());
+    return dia >= 1 && dia <= 31;
+}
+
+void agregarVenta(list<Venta> &ventas, vector<DetalleVenta> &detalles_ventas, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria, TablaIds<Producto> &tabla_productos, set<int> &productos_stock_bajo, TablaIds<Cliente> &tabla_clientes, TablaIds<Vendedor> &tabla_vendedores, TablaIds<Venta> &tabla_ventas, map<string, SketchesVentas> &sketches_ventas){
     Venta venta;
-    cout << "Ingrese el número de venta: ";
-    cin >> venta.nro_venta;
-    cout << "Ingrese la fecha de la venta: ";
+    // La fecha se pide en formato AAAA-MM-DD, porque sus primeros 7 caracteres identifican el mes de la venta:
+    cout << "Ingrese la fecha de la venta (AAAA-MM-DD): ";
     cin >> venta.fecha;
-    cout << "Ingrese el nombre del cliente: ";
-    string nombre_cliente;
-    cin >> nombre_cliente;
-    list<Cliente>::iterator it = find_if(clientes.begin(), clientes.end(), [nombre_cliente](Cliente cliente){
-        return cliente.nombre == nombre_cliente;
-    });
-    if (it != clientes.end()){
-        venta.cliente = *it;
+    while (!fechaValida(venta.fecha)){
+        if (cin.eof()){
+            return;
+        }
+        cout << "Fecha no válida. Ingrese la fecha de la venta (AAAA-MM-DD): ";
+        cin >> venta.fecha;
+    }
+    cout << "Ingrese el id del cliente: ";
+    int id_cliente;
+    cin >> id_cliente;
+    if (tabla_clientes.existe(id_cliente)){
+        venta.cliente = *tabla_clientes.buscar(id_cliente);
     } else {
         cout << "El cliente no existe." << endl;
         return;
     }
     cout << "Ingrese el total de la venta: ";
     cin >> venta.total;
-    cout << "Ingrese el nombre del vendedor: ";
-    string nombre_vendedor;
-    cin >> nombre_vendedor;
-    list<Vendedor>::iterator it2 = find_if(vendedores.begin(), vendedores.end(), [nombre_vendedor](Vendedor vendedor){
-        return vendedor.nombre == nombre_vendedor;
-    });
-    if (it2 != vendedores.end()){
-        venta.vendedor = *it2;
+    cout << "Ingrese el id del vendedor: ";
+    int id_vendedor;
+    cin >> id_vendedor;
+    if (tabla_vendedores.existe(id_vendedor)){
+        venta.vendedor = *tabla_vendedores.buscar(id_vendedor);
     } else {
         cout << "El vendedor no existe." << endl;
         return;
     }
-    ventas.push_back(venta);
-    int nro_detalle = 1;
-    int opcion;
-    do{
+    // Reunir primero los detalles válidos; la venta solo se registra y el stock solo se descuenta al terminar,
+    // de modo que cancelarla no deja una venta sin detalles:
+    vector<DetalleVenta> detalles;
+    // Unidades ya pedidas de cada producto en esta venta, por id de producto:
+    map<int, int> reservado;
+    int opcion = 1;
+    while (opcion != 0){
         DetalleVenta detalle_venta;
-        detalle_venta.nro_detalle = nro_detalle;
-        detalle_venta.venta = venta;
-        cout << "Ingrese el código del producto: ";
-        string codigo;
-        cin >> codigo;
-        list<Producto>::iterator it3 = find_if(productos.begin(), productos.end(), [codigo](Producto producto){
-            return producto.codigo == codigo;
-        });
-        if (it3 != productos.end()){
-            detalle_venta.producto = *it3;
-        } else {
-            cout << "El producto no existe." << endl;
-            return;
+        // Pedir el producto y la cantidad hasta que sean válidos, o el código 0 para terminar la venta:
+        while (true){
+            cout << "Ingrese el código del producto (0 para terminar): ";
+            string codigo;
+            cin >> codigo;
+            if (cin.eof()){
+                cout << "Venta cancelada." << endl;
+                return;
+            }
+            if (codigo == "0"){
+                opcion = 0;
+                break;
+            }
+            map<string, Producto>::iterator it3 = productos_codigo.find(codigo);
+            if (it3 == productos_codigo.end()){
+                cout << "El producto no existe." << endl;
+                continue;
+            }
+            detalle_venta.producto = it3->second;
+            int disponible = detalle_venta.producto.cantidad - reservado[detalle_venta.producto.id];
+            cout << "Ingrese la cantidad del producto: ";
+            cin >> detalle_venta.cantidad;
+            if (cin.eof()){
+                cout << "Venta cancelada." << endl;
+                return;
+            }
+            if (cin.fail()){
+                cin.clear();
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                detalle_venta.cantidad = 0;
+            }
+            if (detalle_venta.cantidad <= 0){
+                cout << "La cantidad debe ser mayor a cero." << endl;
+            } else if (detalle_venta.cantidad > disponible){
+                cout << "Stock insuficiente. Disponible: " << disponible << endl;
+            } else {
+                break;
+            }
+        }
+        if (opcion == 0){
+            break;
         }
-        cout << "Ingrese la cantidad del producto: ";
-        cin >> detalle_venta.cantidad;
+        reservado[detalle_venta.producto.id] += detalle_venta.cantidad;
+        detalle_venta.nro_detalle = detalles.size() + 1;
         detalle_venta.subtotal = detalle_venta.cantidad * detalle_venta.producto.precio;
-        detalles_ventas.push_back(detalle_venta);
-        nro_detalle = nro_detalle + 1;
+        detalles.push_back(detalle_venta);
         cout << "Desea agregar otro producto a la venta? (1. Sí, 0. No): ";
         cin >> opcion;
-    } while (opcion != 0);
+        if (cin.eof()){
+            cout << "Venta cancelada." << endl;
+            return;
+        }
+        if (cin.fail()){
+            cin.clear();
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            opcion = 1;
+        }
+    }
+    if (detalles.empty()){
+        cout << "La venta no tiene productos y no se registró." << endl;
+        return;
+    }
+    // El número de venta se asigna automáticamente, por lo que no puede repetirse:
+    venta.nro_venta = tabla_ventas.asignarId();
+    ventas.push_back(venta);
+    tabla_ventas.registrar(venta.nro_venta, prev(ventas.end()));
+    SketchesVentas &sketches = sketches_ventas[venta.fecha.substr(0, 7)];
+    for (size_t i = 0; i < detalles.size(); i++){
+        DetalleVenta &detalle_venta = detalles[i];
+        detalle_venta.venta = venta;
+        // Descontar la cantidad vendida del stock actual del producto:
+        Producto &producto = *tabla_productos.buscar(detalle_venta.producto.id);
+        cambiarCantidadProducto(producto, producto.cantidad - detalle_venta.cantidad, productos_codigo, productos_categoria, productos_stock_bajo);
+        detalles_ventas.push_back(detalle_venta);
+        // Registrar el detalle en los resúmenes aproximados del mes de la venta:
+        sketches.agregarVenta(detalle_venta.producto.codigo, venta.cliente.id, venta.vendedor.id, detalle_venta.cantidad);
+    }
+    tabla_productos.marcarCambio();
+    tabla_ventas.marcarCambio();
+    cout << "Venta registrada con el número " << venta.nro_venta << "." << endl;
 }
 
-void mostrarVentas(list<Venta> &ventas, list<DetalleVenta> &detalles_ventas){
-    for (list<Venta>::iterator it = ventas.begin(); it != ventas.end(); it++){
-        cout << "Número de venta: " << it->nro_venta << endl;
-        cout << "Fecha: " << it->fecha << endl;
-        cout << "Cliente: " << it->cliente.nombre << " " << it->cliente.apellido << endl;
-        cout << "Total: " << it->total << endl;
-        cout << "Vendedor: " << it->vendedor.nombre << " " << it->vendedor.apellido << endl;
-        for (list<DetalleVenta>::iterator it2 = detalles_ventas.begin(); it2 != detalles_ventas.end(); it2++){
-            if (it->nro_venta == it2->venta.nro_venta){
-                cout << "Número de detalle: " << it2->nro_detalle << endl;
-                cout << "Producto: " << it2->producto.nombre << endl;
-                cout << "Cantidad: " << it2->cantidad << endl;
-                cout << "Subtotal: " << it2->subtotal << endl;
+void mostrarVentas(list<Venta> &ventas, vector<DetalleVenta> &detalles_ventas, TablaIds<Venta> &tabla_ventas, CacheConsultas &cache_consultas){
+    // Usar el listado anterior si no cambiaron las ventas ni sus detalles:
+    vector<long> versiones = {tabla_ventas.version};
+    string resultado;
+    if (!cache_consultas.buscar("ventas", versiones, resultado)){
+        stringstream salida;
+        for (list<Venta>::iterator it = ventas.begin(); it != ventas.end(); it++){
+            salida << "Número de venta: " << it->nro_venta << endl;
+            salida << "Fecha: " << it->fecha << endl;
+            salida << "Cliente: " << it->cliente.nombre << " " << it->cliente.apellido << endl;
+            salida << "Total: " << it->total << endl;
+            salida << "Vendedor: " << it->vendedor.nombre << " " << it->vendedor.apellido << endl;
+            for (vector<DetalleVenta>::iterator it2 = detalles_ventas.begin(); it2 != detalles_ventas.end(); it2++){
+                if (it->nro_venta == it2->venta.nro_venta){
+                    salida << "Número de detalle: " << it2->nro_detalle << endl;
+                    salida << "Producto: " << it2->producto.nombre << endl;
+                    salida << "Cantidad: " << it2->cantidad << endl;
+                    salida << "Subtotal: " << it2->subtotal << endl;
+                }
             }
         }
+        resultado = salida.str();
+        cache_consultas.guardar("ventas", versiones, resultado);
     }
+    cout << resultado;
 }
 
-void mostrarDetalleVenta(list<DetalleVenta> &detalles_ventas){
-    for (list<DetalleVenta>::iterator it = detalles_ventas.begin(); it != detalles_ventas.end(); it++){
+void mostrarDetalleVenta(vector<DetalleVenta> &detalles_ventas){
+    for (vector<DetalleVenta>::iterator it = detalles_ventas.begin(); it != detalles_ventas.end(); it++){
         cout << "Número de detalle: " << it->nro_detalle << endl;
         cout << "Venta: " << it->venta.nro_venta << endl;
         cout << "Producto: " << it->producto.nombre << endl;
@@ -598,7 +1463,299 @@ void mostrarDetalleVenta(list<DetalleVenta> &detalles_ventas){
     }
 }
 
-void agregarVendedor(list<Vendedor> &vendedores){
+// Tablero aproximado: responde una consulta sobre los meses del rango sin recorrer las ventas. Solo se
+// combinan los resúmenes que la consulta necesita: las unidades vendidas para los productos más vendidos,
+// o el HyperLogLog de un producto o de un vendedor para sus clientes distintos.
+void mostrarTableroAproximado(map<string, SketchesVentas> &sketches_ventas, TablaIds<Vendedor> &tabla_vendedores){
+    string desde, hasta;
+    cout << "Ingrese el mes inicial (AAAA-MM): ";
+    cin >> desde;
+    cout << "Ingrese el mes final (AAAA-MM): ";
+    cin >> hasta;
+    if (!periodoValido(desde) || !periodoValido(hasta)){
+        cout << "Mes no válido." << endl;
+        return;
+    }
+    map<string, SketchesVentas>::iterator inicio = sketches_ventas.lower_bound(desde);
+    map<string, SketchesVentas>::iterator fin = sketches_ventas.upper_bound(hasta);
+    if (desde > hasta || inicio == fin){
+        cout << "No hay ventas registradas en el rango." << endl;
+        return;
+    }
+    cout << "1. Productos más vendidos" << endl;
+    cout << "2. Clientes distintos de un producto" << endl;
+    cout << "3. Clientes distintos de un vendedor" << endl;
+    cout << "Seleccione una consulta: ";
+    int consulta = 0;
+    cin >> consulta;
+    if (consulta == 1){
+        SketchesVentas combinado;
+        for (map<string, SketchesVentas>::iterator it = inicio; it != fin; it++){
+            combinado.combinarUnidades(it->second);
+        }
+        cout << endl << "Productos más vendidos (unidades aproximadas):" << endl;
+        vector<pair<long long, string>> frecuentes = combinado.frecuentes;
+        sort(frecuentes.rbegin(), frecuentes.rend());
+        for (size_t i = 0; i < frecuentes.size(); i++){
+            cout << frecuentes[i].second << ": " << frecuentes[i].first << endl;
+        }
+    } else if (consulta == 2){
+        string codigo;
+        cout << "Ingrese el código del producto: ";
+        cin >> codigo;
+        HyperLogLog clientes_producto;
+        for (map<string, SketchesVentas>::iterator it = inicio; it != fin; it++){
+            map<string, HyperLogLog>::iterator it2 = it->second.clientes_producto.find(codigo);
+            if (it2 != it->second.clientes_producto.end()){
+                clientes_producto.combinar(it2->second);
+            }
+        }
+        cout << "Clientes distintos del producto " << codigo << " (aproximado): " << llround(clientes_producto.estimar()) << endl;
+    } else if (consulta == 3){
+        int id_vendedor = 0;
+        cout << "Ingrese el id del vendedor: ";
+        cin >> id_vendedor;
+        HyperLogLog clientes_vendedor;
+        for (map<string, SketchesVentas>::iterator it = inicio; it != fin; it++){
+            map<int, HyperLogLog>::iterator it2 = it->second.clientes_vendedor.find(id_vendedor);
+            if (it2 != it->second.clientes_vendedor.end()){
+                clientes_vendedor.combinar(it2->second);
+            }
+        }
+        cout << "Clientes distintos del vendedor " << id_vendedor;
+        if (tabla_vendedores.existe(id_vendedor)){
+            cout << " " << tabla_vendedores.buscar(id_vendedor)->nombre;
+        }
+        cout << " (aproximado): " << llround(clientes_vendedor.estimar()) << endl;
+    } else {
+        cout << "Opción no válida." << endl;
+    }
+}
+
+// Ejecutar las tareas con un grupo de hilos con robo de trabajo. Las tareas se reparten entre las colas
+// de los hilos; cada hilo toma tareas del inicio de su cola y, cuando se vacía, roba del final de las
+// colas de los demás. Cada tarea recibe el número del hilo que la ejecuta.
+void ejecutarTareasEnParalelo(vector<function<void(int)>> &tareas, int num_hilos){
+    // No iniciar más hilos que tareas; con una sola tarea se ejecuta en el hilo actual:
+    num_hilos = min(num_hilos, (int)tareas.size());
+    if (num_hilos <= 1){
+        for (int i = 0; i < (int)tareas.size(); i++){
+            tareas[i](0);
+        }
+        return;
+    }
+    vector<deque<int>> colas(num_hilos);
+    vector<mutex> mutex_colas(num_hilos);
+    for (int i = 0; i < (int)tareas.size(); i++){
+        colas[i % num_hilos].push_back(i);
+    }
+    vector<thread> hilos;
+    for (int h = 0; h < num_hilos; h++){
+        hilos.push_back(thread([&tareas, &colas, &mutex_colas, num_hilos, h](){
+            while (true){
+                int tarea = -1;
+                // Tomar una tarea de la cola propia:
+                {
+                    lock_guard<mutex> bloqueo(mutex_colas[h]);
+                    if (!colas[h].empty()){
+                        tarea = colas[h].front();
+                        colas[h].pop_front();
+                    }
+                }
+                // Si la cola propia está vacía, robar una tarea de otro hilo:
+                for (int i = 1; i < num_hilos && tarea == -1; i++){
+                    int victima = (h + i) % num_hilos;
+                    lock_guard<mutex> bloqueo(mutex_colas[victima]);
+                    if (!colas[victima].empty()){
+                        tarea = colas[victima].back();
+                        colas[victima].pop_back();
+                    }
+                }
+                // No se crean tareas nuevas durante la ejecución, así que si no hay nada que robar se terminó:
+                if (tarea == -1){
+                    return;
+                }
+                tareas[tarea](h);
+            }
+        }));
+    }
+    for (int h = 0; h < num_hilos; h++){
+        hilos[h].join();
+    }
+}
+
+// Cierre de mes: calcula las comisiones de los vendedores, los ingresos por categoría y por cliente, y
+// verifica que el total de cada venta coincida con la suma de sus detalles. Los números de venta y los
+// detalles se dividen en tramos que se procesan en paralelo; cada tarea decide por sí misma qué ventas
+// son del periodo, y solo la suma de los resúmenes parciales se hace en un hilo. El resultado se guarda
+// en cierre_<periodo>.txt.
+void cierreMes(vector<DetalleVenta> &detalles_ventas, TablaIds<Cliente> &tabla_clientes, TablaIds<Vendedor> &tabla_vendedores, TablaIds<Venta> &tabla_ventas, CacheConsultas &cache_consultas){
+    string periodo;
+    cout << "Ingrese el periodo a cerrar (AAAA-MM): ";
+    cin >> periodo;
+    while (!periodoValido(periodo)){
+        if (cin.eof()){
+            return;
+        }
+        cout << "Periodo no válido. Ingrese el periodo a cerrar (AAAA-MM): ";
+        cin >> periodo;
+    }
+    string nombre_archivo = "cierre_" + periodo + ".txt";
+
+    // Si no hubo cambios desde el último cierre del mismo periodo, volver a guardar ese reporte:
+    string clave = "cierre " + periodo;
+    vector<long> versiones = {tabla_ventas.version, tabla_clientes.version, tabla_vendedores.version};
+    string resultado;
+    if (cache_consultas.buscar(clave, versiones, resultado)){
+        ofstream archivo_cierre(nombre_archivo);
+        archivo_cierre << resultado;
+        archivo_cierre.close();
+        cout << "Sin cambios desde el último cierre del periodo." << endl;
+        cout << "Reporte de cierre guardado en " << nombre_archivo << endl;
+        return;
+    }
+
+    // Tareas sobre tramos de números de venta: cada una busca sus ventas en la tabla de ventas, marca las
+    // del periodo y suma los totales por vendedor y por cliente.
+    int total_ventas = tabla_ventas.siguiente_id;
+    vector<char> en_periodo(total_ventas, 0);
+    vector<function<void(int)>> tareas;
+    vector<ResumenCierre> parciales;
+    for (int inicio = 1; inicio < total_ventas; inicio += VENTAS_POR_TAREA){
+        int fin = min(inicio + VENTAS_POR_TAREA, total_ventas);
+        tareas.push_back([&, inicio, fin](int h){
+            ResumenCierre &resumen = parciales[h];
+            for (int nro = inicio; nro < fin; nro++){
+                if (!tabla_ventas.existe(nro)){
+                    continue;
+                }
+                Venta &venta = *tabla_ventas.buscar(nro);
+                if (venta.fecha.compare(0, 7, periodo) != 0){
+                    continue;
+                }
+                en_periodo[nro] = 1;
+                resumen.cantidad_ventas++;
+                if (venta.vendedor.id > 0 && venta.vendedor.id < (int)resumen.ventas_vendedor.size()){
+                    resumen.ventas_vendedor[venta.vendedor.id] += venta.total;
+                    resumen.cantidad_ventas_vendedor[venta.vendedor.id]++;
+                }
+                if (venta.cliente.id > 0 && venta.cliente.id < (int)resumen.ventas_cliente.size()){
+                    resumen.ventas_cliente[venta.cliente.id] += venta.total;
+                }
+            }
+        });
+    }
+
+    // Tareas sobre tramos del vector de detalles: cada una toma los detalles de ventas del periodo y suma
+    // por categoría en el mapa de su hilo. La suma de los detalles de una venta puede venir de varias
+    // tareas, por eso se acumula con operaciones atómicas.
+    vector<atomic<double>> suma_detalles(total_ventas);
+    vector<atomic<int>> cantidad_detalles(total_ventas);
+    for (int inicio = 0; inicio < (int)detalles_ventas.size(); inicio += DETALLES_POR_TAREA){
+        int fin = min(inicio + DETALLES_POR_TAREA, (int)detalles_ventas.size());
+        tareas.push_back([&, inicio, fin](int h){
+            ResumenCierre &resumen = parciales[h];
+            for (int d = inicio; d < fin; d++){
+                DetalleVenta &detalle = detalles_ventas[d];
+                int nro = detalle.venta.nro_venta;
+                if (!tabla_ventas.existe(nro) || tabla_ventas.buscar(nro)->fecha.compare(0, 7, periodo) != 0){
+                    continue;
+                }
+                resumen.ventas_categoria[detalle.producto.categoria] += detalle.subtotal;
+                double suma = suma_detalles[nro].load();
+                while (!suma_detalles[nro].compare_exchange_weak(suma, suma + detalle.subtotal)){
+                }
+                cantidad_detalles[nro]++;
+            }
+        });
+    }
+
+    // Preparar un resumen parcial por hilo, sin iniciar más hilos que tareas:
+    int num_hilos = max(1, min((int)thread::hardware_concurrency(), (int)tareas.size()));
+    parciales.resize(num_hilos);
+    for (int h = 0; h < num_hilos; h++){
+        parciales[h].ventas_vendedor.assign(tabla_vendedores.siguiente_id, 0);
+        parciales[h].cantidad_ventas_vendedor.assign(tabla_vendedores.siguiente_id, 0);
+        parciales[h].ventas_cliente.assign(tabla_clientes.siguiente_id, 0);
+    }
+    ejecutarTareasEnParalelo(tareas, num_hilos);
+
+    // Sumar los resúmenes parciales en el primero; las categorías quedan ordenadas por nombre para el reporte:
+    ResumenCierre &resumen = parciales[0];
+    map<string, double> ventas_categoria(resumen.ventas_categoria.begin(), resumen.ventas_categoria.end());
+    for (int h = 1; h < num_hilos; h++){
+        resumen.cantidad_ventas += parciales[h].cantidad_ventas;
+        for (int i = 0; i < (int)resumen.ventas_vendedor.size(); i++){
+            resumen.ventas_vendedor[i] += parciales[h].ventas_vendedor[i];
+            resumen.cantidad_ventas_vendedor[i] += parciales[h].cantidad_ventas_vendedor[i];
+        }
+        for (int i = 0; i < (int)resumen.ventas_cliente.size(); i++){
+            resumen.ventas_cliente[i] += parciales[h].ventas_cliente[i];
+        }
+        for (unordered_map<string, double>::iterator it = parciales[h].ventas_categoria.begin(); it != parciales[h].ventas_categoria.end(); it++){
+            ventas_categoria[it->first] += it->second;
+        }
+    }
+    if (resumen.cantidad_ventas == 0){
+        cout << "No hay ventas en el periodo." << endl;
+        return;
+    }
+
+    // Armar el reporte de cierre:
+    stringstream reporte;
+    reporte << fixed << setprecision(2);
+    reporte << "Cierre del periodo " << periodo << endl;
+    reporte << "Ventas del periodo: " << resumen.cantidad_ventas << endl;
+    reporte << endl << "Comisiones por vendedor (tasa " << TASA_COMISION * 100 << "%):" << endl;
+    for (int id = 1; id < tabla_vendedores.siguiente_id; id++){
+        if (!tabla_vendedores.existe(id)){
+            continue;
+        }
+        Vendedor &vendedor = *tabla_vendedores.buscar(id);
+        double comision = resumen.ventas_vendedor[id] * TASA_COMISION;
+        reporte << id << " " << vendedor.nombre << " " << vendedor.apellido << " ventas: " << resumen.cantidad_ventas_vendedor[id] << " total vendido: " << resumen.ventas_vendedor[id] << " comisión: " << comision << " a pagar: " << vendedor.salario + comision << endl;
+    }
+    reporte << endl << "Ingresos por categoría:" << endl;
+    for (map<string, double>::iterator it = ventas_categoria.begin(); it != ventas_categoria.end(); it++){
+        reporte << it->first << ": " << it->second << endl;
+    }
+    reporte << endl << "Ingresos por cliente:" << endl;
+    for (int id = 1; id < tabla_clientes.siguiente_id; id++){
+        if (tabla_clientes.existe(id) && resumen.ventas_cliente[id] != 0){
+            Cliente &cliente = *tabla_clientes.buscar(id);
+            reporte << id << " " << cliente.nombre << " " << cliente.apellido << ": " << resumen.ventas_cliente[id] << endl;
+        }
+    }
+    reporte << endl << "Ventas cuyo total no coincide con sus detalles:" << endl;
+    int descuadradas = 0;
+    int sin_detalle = 0;
+    for (int nro = 1; nro < total_ventas; nro++){
+        if (!en_periodo[nro]){
+            continue;
+        }
+        Venta &venta = *tabla_ventas.buscar(nro);
+        if (cantidad_detalles[nro] == 0){
+            sin_detalle++;
+        } else if (fabs(suma_detalles[nro] - venta.total) > 0.01){
+            reporte << "Venta " << nro << " total: " << venta.total << " suma de detalles: " << suma_detalles[nro] << endl;
+            descuadradas++;
+        }
+    }
+    reporte << "Ventas descuadradas: " << descuadradas << endl;
+    reporte << "Ventas sin detalle: " << sin_detalle << endl;
+    resultado = reporte.str();
+    cache_consultas.guardar(clave, versiones, resultado);
+    ofstream archivo_cierre(nombre_archivo);
+    archivo_cierre << resultado;
+    archivo_cierre.close();
+
+    cout << "Ventas del periodo: " << resumen.cantidad_ventas << endl;
+    cout << "Ventas descuadradas: " << descuadradas << endl;
+    cout << "Ventas sin detalle: " << sin_detalle << endl;
+    cout << "Reporte de cierre guardado en " << nombre_archivo << endl;
+}
+
+void agregarVendedor(list<Vendedor> &vendedores, TablaIds<Vendedor> &tabla_vendedores){
     Vendedor vendedor;
     cout << "Ingrese el nombre del vendedor: ";
     cin >> vendedor.nombre;
@@ -614,11 +1771,15 @@ void agregarVendedor(list<Vendedor> &vendedores){
     cin >> vendedor.salario;
     cout << "Ingrese las ventas realizadas del vendedor: ";
     cin >> vendedor.ventas_realizadas;
+    vendedor.id = tabla_vendedores.asignarId();
     vendedores.push_back(vendedor);
+    tabla_vendedores.registrar(vendedor.id, prev(vendedores.end()));
+    cout << "Vendedor registrado con el id " << vendedor.id << "." << endl;
 }
 
 void mostrarVendedores(list<Vendedor> &vendedores){
     for (list<Vendedor>::iterator it = vendedores.begin(); it != vendedores.end(); it++){
+        cout << "ID: " << it->id << endl;
         cout << "Nombre: " << it->nombre << endl;
         cout << "Apellido: " << it->apellido << endl;
         cout << "Teléfono: " << it->telefono << endl;
@@ -653,88 +1814,417 @@ void mostrarVendedorNuevo(queue<Vendedor> &vendedores_nuevos){
     }
 }
 
+int contarCampos(const string &linea){
+    istringstream entrada(linea);
+    string campo;
+    int campos = 0;
+    while (entrada >> campo){
+        campos++;
+    }
+    return campos;
+}
+
+void registrarLineaNoValida(set<string> &archivos_con_errores, const string &nombre_archivo, const string &linea){
+    cout << "Línea no válida en " << nombre_archivo << ": " << linea << endl;
+    archivos_con_errores.insert(nombre_archivo);
+}
+
+bool puedeGuardarArchivo(set<string> &archivos_con_errores, const string &nombre_archivo){
+    if (archivos_con_errores.count(nombre_archivo)){
+        cout << "No se guardó " << nombre_archivo << " porque tiene líneas no válidas. Corríjalas y vuelva a cargarlo." << endl;
+        return false;
+    }
+    return true;
+}
+
+// Escribir un HyperLogLog después de su clave. La forma completa se guarda como un carácter por registro a
+// partir de '0'; la dispersa como "s <cantidad>" seguido de los pares índice valor:
+void escribirHll(ostream &archivo, const HyperLogLog &hll){
+    if (hll.esDenso()){
+        for (size_t i = 0; i < hll.registros.size(); i++){
+            archivo << (char)('0' + hll.registros[i]);
+        }
+    } else {
+        archivo << "s " << hll.disperso.size();
+        for (size_t i = 0; i < hll.disperso.size(); i++){
+            archivo << " " << (hll.disperso[i] >> 8) << " " << (hll.disperso[i] & 0xFF);
+        }
+    }
+    archivo << endl;
+}
+
+// Leer un HyperLogLog escrito con escribirHll. Devuelve false si está incompleto o tiene valores fuera de rango:
+bool leerHll(istream &archivo, HyperLogLog &hll){
+    string registros;
+    // Una clave repetida en el mismo periodo también se considera un error:
+    if (hll.esDenso() || !hll.disperso.empty() || !(archivo >> registros)){
+        return false;
+    }
+    if (registros == "s"){
+        int cantidad;
+        if (!(archivo >> cantidad) || cantidad < 0 || cantidad > HyperLogLog::LIMITE_DISPERSO){
+            return false;
+        }
+        int anterior = -1;
+        for (int i = 0; i < cantidad; i++){
+            int indice, valor;
+            // Los índices deben venir ordenados y sin repetir:
+            if (!(archivo >> indice >> valor) || indice <= anterior || indice >= HyperLogLog::REGISTROS || valor < 1 || valor > 64 - PRECISION_HLL + 1){
+                return false;
+            }
+            hll.disperso.push_back(((unsigned int)indice << 8) | valor);
+            anterior = indice;
+        }
+        return true;
+    }
+    if ((int)registros.size() != HyperLogLog::REGISTROS){
+        return false;
+    }
+    hll.registros.assign(HyperLogLog::REGISTROS, 0);
+    for (size_t i = 0; i < registros.size(); i++){
+        int valor = registros[i] - '0';
+        if (valor < 0 || valor > 64 - PRECISION_HLL + 1){
+            return false;
+        }
+        hll.registros[i] = valor;
+    }
+    // Los archivos anteriores guardaban siempre la forma completa; pasar a la dispersa si ocupa menos:
+    if (HyperLogLog::REGISTROS - count(hll.registros.begin(), hll.registros.end(), 0) <= HyperLogLog::LIMITE_DISPERSO){
+        for (int i = 0; i < HyperLogLog::REGISTROS; i++){
+            if (hll.registros[i] != 0){
+                hll.disperso.push_back(((unsigned int)i << 8) | hll.registros[i]);
+            }
+        }
+        hll.registros.clear();
+    }
+    return true;
+}
+
+// Leer los resúmenes de un periodo de sketches.txt. Devuelve false si están incompletos o dañados:
+bool leerSketchesPeriodo(istream &archivo, SketchesVentas &sketches){
+    string etiqueta, codigo;
+    int cantidad;
+    if (!(archivo >> etiqueta) || etiqueta != "count_min"){
+        return false;
+    }
+    for (size_t i = 0; i < sketches.unidades_producto.contadores.size(); i++){
+        if (!(archivo >> sketches.unidades_producto.contadores[i])){
+            return false;
+        }
+    }
+    if (!(archivo >> etiqueta >> cantidad) || etiqueta != "frecuentes" || cantidad < 0 || cantidad > CANTIDAD_FRECUENTES){
+        return false;
+    }
+    for (int i = 0; i < cantidad; i++){
+        long long conteo;
+        if (!(archivo >> codigo >> conteo)){
+            return false;
+        }
+        sketches.frecuentes.push_back(make_pair(conteo, codigo));
+    }
+    make_heap(sketches.frecuentes.begin(), sketches.frecuentes.end(), greater<pair<long long, string>>());
+    if (!(archivo >> etiqueta >> cantidad) || etiqueta != "productos" || cantidad < 0){
+        return false;
+    }
+    for (int i = 0; i < cantidad; i++){
+        if (!(archivo >> codigo) || !leerHll(archivo, sketches.clientes_producto[codigo])){
+            return false;
+        }
+    }
+    if (!(archivo >> etiqueta >> cantidad) || etiqueta != "vendedores" || cantidad < 0){
+        return false;
+    }
+    for (int i = 0; i < cantidad; i++){
+        int id_vendedor;
+        if (!(archivo >> id_vendedor) || !leerHll(archivo, sketches.clientes_vendedor[id_vendedor])){
+            return false;
+        }
+    }
+    return true;
+}
+
 // Función para cargar la información de los archivos:
-void cargarInformacion(list<Producto> &productos, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria, list<Cliente> &clientes, list<Venta> &ventas, list<Vendedor> &vendedores, queue<Proveedor> &proveedores){
-    // Cargar la información de los productos desde un archivo:
+void cargarInformacion(list<Producto> &productos, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria, list<Cliente> &clientes, list<Venta> &ventas, vector<DetalleVenta> &detalles_ventas, list<Vendedor> &vendedores, queue<Proveedor> &proveedores, TablaIds<Producto> &tabla_productos, TablaIds<Cliente> &tabla_clientes, TablaIds<Vendedor> &tabla_vendedores, TablaIds<Venta> &tabla_ventas, set<int> &productos_stock_bajo, map<string, SketchesVentas> &sketches_ventas, set<string> &archivos_con_errores){
+    // Los archivos se leen línea por línea. Las líneas que no se pueden leer se informan y el archivo no se
+    // sobrescribe al salir. Si el archivo está en el formato anterior (sin id), se asignan ids al cargarlo.
+    string linea;
+
+    // Cargar la información de los proveedores desde un archivo, antes que los productos para poder enlazarlos:
+    ifstream archivo_proveedores("proveedores.txt");
+    map<string, Proveedor> proveedores_nombre;
+    if (archivo_proveedores.is_open()){
+        Proveedor proveedor;
+        while (archivo_proveedores >> proveedor.id >> proveedor.nombre >> proveedor.telefono >> proveedor.correo){
+            proveedores.push(proveedor);
+            proveedores_nombre[proveedor.nombre] = proveedor;
+        }
+        archivo_proveedores.close();
+    }
+
+    // Cargar la información de los productos desde un archivo. Formatos anteriores: 8 campos (sin id, stock
+    // mínimo ni id de proveedor) y 9 campos (con id); en ellos el stock mínimo queda en 0 y el proveedor se
+    // busca por su nombre:
     ifstream archivo_productos("productos.txt");
     if (archivo_productos.is_open()){
-        Producto producto;
-        while (archivo_productos >> producto.codigo >> producto.nombre >> producto.precio >> producto.cantidad >> producto.descripcion >> producto.categoria >> producto.proveedor.nombre >> producto.estado){
+        int formato = 0;
+        while (getline(archivo_productos, linea)){
+            int campos = contarCampos(linea);
+            if (campos == 0){
+                continue;
+            }
+            if (formato == 0){
+                formato = campos;
+            }
+            istringstream entrada(linea);
+            Producto producto;
+            producto.stock_minimo = 0;
+            producto.proveedor.id = 0;
+            bool leido = false;
+            if (campos == formato && formato == 11){
+                leido = (bool)(entrada >> producto.id >> producto.codigo >> producto.nombre >> producto.precio >> producto.cantidad >> producto.stock_minimo >> producto.descripcion >> producto.categoria >> producto.proveedor.id >> producto.proveedor.nombre >> producto.estado);
+            } else if (campos == formato && formato == 9){
+                leido = (bool)(entrada >> producto.id >> producto.codigo >> producto.nombre >> producto.precio >> producto.cantidad >> producto.descripcion >> producto.categoria >> producto.proveedor.nombre >> producto.estado);
+            } else if (campos == formato && formato == 8){
+                leido = (bool)(entrada >> producto.codigo >> producto.nombre >> producto.precio >> producto.cantidad >> producto.descripcion >> producto.categoria >> producto.proveedor.nombre >> producto.estado);
+                producto.id = tabla_productos.siguiente_id;
+            }
+            if (formato != 11){
+                map<string, Proveedor>::iterator it = proveedores_nombre.find(producto.proveedor.nombre);
+                if (it != proveedores_nombre.end()){
+                    producto.proveedor = it->second;
+                }
+            }
+            if (!leido || !tabla_productos.idDisponible(producto.id) || productos_codigo.count(producto.codigo)){
+                registrarLineaNoValida(archivos_con_errores, "productos.txt", linea);
+                continue;
+            }
             productos.push_back(producto);
+            tabla_productos.registrar(producto.id, prev(productos.end()));
             productos_codigo[producto.codigo] = producto;
             productos_categoria[producto.categoria].push_back(producto);
+            actualizarStockBajo(productos_stock_bajo, producto);
         }
         archivo_productos.close();
     }
 
-    // Cargar la información de los clientes desde un archivo:
+    // Cargar la información de los clientes desde un archivo (formato anterior: 6 campos, sin id):
     ifstream archivo_clientes("clientes.txt");
     if (archivo_clientes.is_open()){
-        Cliente cliente;
-        while (archivo_clientes >> cliente.nombre >> cliente.apellido >> cliente.telefono >> cliente.correo >> cliente.direccion >> cliente.nit){
+        int formato = 0;
+        while (getline(archivo_clientes, linea)){
+            int campos = contarCampos(linea);
+            if (campos == 0){
+                continue;
+            }
+            if (formato == 0){
+                formato = campos;
+            }
+            istringstream entrada(linea);
+            Cliente cliente;
+            bool leido = false;
+            if (campos == formato && formato == 7){
+                leido = (bool)(entrada >> cliente.id >> cliente.nombre >> cliente.apellido >> cliente.telefono >> cliente.correo >> cliente.direccion >> cliente.nit);
+            } else if (campos == formato && formato == 6){
+                leido = (bool)(entrada >> cliente.nombre >> cliente.apellido >> cliente.telefono >> cliente.correo >> cliente.direccion >> cliente.nit);
+                cliente.id = tabla_clientes.siguiente_id;
+            }
+            if (!leido || !tabla_clientes.idDisponible(cliente.id)){
+                registrarLineaNoValida(archivos_con_errores, "clientes.txt", linea);
+                continue;
+            }
             clientes.push_back(cliente);
+            tabla_clientes.registrar(cliente.id, prev(clientes.end()));
         }
         archivo_clientes.close();
     }
 
-    // Cargar la información de las ventas desde un archivo:
+    // Cargar la información de los vendedores desde un archivo (formato anterior: 7 campos, sin id):
+    ifstream archivo_vendedores("vendedores.txt");
+    if (archivo_vendedores.is_open()){
+        int formato = 0;
+        while (getline(archivo_vendedores, linea)){
+            int campos = contarCampos(linea);
+            if (campos == 0){
+                continue;
+            }
+            if (formato == 0){
+                formato = campos;
+            }
+            istringstream entrada(linea);
+            Vendedor vendedor;
+            bool leido = false;
+            if (campos == formato && formato == 8){
+                leido = (bool)(entrada >> vendedor.id >> vendedor.nombre >> vendedor.apellido >> vendedor.telefono >> vendedor.correo >> vendedor.direccion >> vendedor.salario >> vendedor.ventas_realizadas);
+            } else if (campos == formato && formato == 7){
+                leido = (bool)(entrada >> vendedor.nombre >> vendedor.apellido >> vendedor.telefono >> vendedor.correo >> vendedor.direccion >> vendedor.salario >> vendedor.ventas_realizadas);
+                vendedor.id = tabla_vendedores.siguiente_id;
+            }
+            if (!leido || !tabla_vendedores.idDisponible(vendedor.id)){
+                registrarLineaNoValida(archivos_con_errores, "vendedores.txt", linea);
+                continue;
+            }
+            vendedores.push_back(vendedor);
+            tabla_vendedores.registrar(vendedor.id, prev(vendedores.end()));
+        }
+        archivo_vendedores.close();
+    }
+
+    // Cargar la información de las ventas desde un archivo, enlazando el cliente y el vendedor por su id.
+    // En el formato anterior (5 campos) el cliente y el vendedor se buscan por su nombre:
     ifstream archivo_ventas("ventas.txt");
     if (archivo_ventas.is_open()){
-        Venta venta;
-        while (archivo_ventas >> venta.nro_venta >> venta.fecha >> venta.cliente.nombre >> venta.total >> venta.vendedor.nombre){
+        while (getline(archivo_ventas, linea)){
+            int campos = contarCampos(linea);
+            if (campos == 0){
+                continue;
+            }
+            istringstream entrada(linea);
+            Venta venta;
+            bool leido = false;
+            if (campos == 7){
+                leido = (bool)(entrada >> venta.nro_venta >> venta.fecha >> venta.cliente.id >> venta.cliente.nombre >> venta.total >> venta.vendedor.id >> venta.vendedor.nombre);
+            } else if (campos == 5){
+                leido = (bool)(entrada >> venta.nro_venta >> venta.fecha >> venta.cliente.nombre >> venta.total >> venta.vendedor.nombre);
+                string nombre_cliente = venta.cliente.nombre;
+                string nombre_vendedor = venta.vendedor.nombre;
+                list<Cliente>::iterator it = find_if(clientes.begin(), clientes.end(), [nombre_cliente](const Cliente &cliente){
+                    return cliente.nombre == nombre_cliente;
+                });
+                venta.cliente.id = it != clientes.end() ? it->id : 0;
+                list<Vendedor>::iterator it2 = find_if(vendedores.begin(), vendedores.end(), [nombre_vendedor](const Vendedor &vendedor){
+                    return vendedor.nombre == nombre_vendedor;
+                });
+                venta.vendedor.id = it2 != vendedores.end() ? it2->id : 0;
+            }
+            if (!leido || !tabla_ventas.idDisponible(venta.nro_venta)){
+                registrarLineaNoValida(archivos_con_errores, "ventas.txt", linea);
+                continue;
+            }
+            if (tabla_clientes.existe(venta.cliente.id)){
+                venta.cliente = *tabla_clientes.buscar(venta.cliente.id);
+            }
+            if (tabla_vendedores.existe(venta.vendedor.id)){
+                venta.vendedor = *tabla_vendedores.buscar(venta.vendedor.id);
+            }
             ventas.push_back(venta);
+            tabla_ventas.registrar(venta.nro_venta, prev(ventas.end()));
         }
         archivo_ventas.close();
     }
 
-    // Cargar la información de los vendedores desde un archivo:
-    ifstream archivo_vendedores("vendedores.txt");
-    if (archivo_vendedores.is_open()){
-        Vendedor vendedor;
-        while (archivo_vendedores >> vendedor.nombre >> vendedor.apellido >> vendedor.telefono >> vendedor.correo >> vendedor.direccion >> vendedor.salario >> vendedor.ventas_realizadas){
-            vendedores.push_back(vendedor);
+    // Cargar los detalles de las ventas, enlazando cada detalle con su venta por el número de venta. El
+    // producto se guarda como estaba al momento de la venta:
+    ifstream archivo_detalles("detalles.txt");
+    if (archivo_detalles.is_open()){
+        while (getline(archivo_detalles, linea)){
+            int campos = contarCampos(linea);
+            if (campos == 0){
+                continue;
+            }
+            istringstream entrada(linea);
+            DetalleVenta detalle;
+            bool leido = campos == 9 && (bool)(entrada >> detalle.nro_detalle >> detalle.venta.nro_venta >> detalle.producto.id >> detalle.producto.codigo >> detalle.producto.nombre >> detalle.producto.categoria >> detalle.producto.precio >> detalle.cantidad >> detalle.subtotal);
+            if (!leido || !tabla_ventas.existe(detalle.venta.nro_venta)){
+                registrarLineaNoValida(archivos_con_errores, "detalles.txt", linea);
+                continue;
+            }
+            detalle.venta = *tabla_ventas.buscar(detalle.venta.nro_venta);
+            detalles_ventas.push_back(detalle);
         }
-        archivo_vendedores.close();
+        archivo_detalles.close();
     }
 
-    // Cargar la información de los proveedores desde un archivo:
-    ifstream archivo_proveedores("proveedores.txt");
-    if (archivo_proveedores.is_open()){
-        Proveedor proveedor;
-        while (archivo_proveedores >> proveedor.id >> proveedor.nombre >> proveedor.telefono >> proveedor.correo){
-            proveedores.push(proveedor);
+    // Cargar los siguientes ids a asignar, para no reutilizar los ids de elementos eliminados:
+    ifstream archivo_ids("ids.txt");
+    if (archivo_ids.is_open()){
+        int id_producto, id_cliente, id_vendedor, id_venta;
+        if (!(archivo_ids >> id_producto >> id_cliente >> id_vendedor >> id_venta) || !tabla_productos.idEnRango(id_producto) || !tabla_clientes.idEnRango(id_cliente) || !tabla_vendedores.idEnRango(id_vendedor) || !tabla_ventas.idEnRango(id_venta)){
+            cout << "El archivo ids.txt no es válido y no se cargó." << endl;
+            archivos_con_errores.insert("ids.txt");
+        } else {
+            tabla_productos.siguiente_id = max(tabla_productos.siguiente_id, id_producto);
+            tabla_clientes.siguiente_id = max(tabla_clientes.siguiente_id, id_cliente);
+            tabla_vendedores.siguiente_id = max(tabla_vendedores.siguiente_id, id_vendedor);
+            tabla_ventas.siguiente_id = max(tabla_ventas.siguiente_id, id_venta);
         }
-        archivo_proveedores.close();
+        archivo_ids.close();
+    }
+
+    // Cargar los resúmenes aproximados de ventas, solo si se guardaron con la misma configuración. Los
+    // periodos incompletos o dañados se descartan y el archivo no se sobrescribe al salir:
+    ifstream archivo_sketches("sketches.txt");
+    if (archivo_sketches.is_open()){
+        string etiqueta;
+        int precision = 0, ancho = 0, profundidad = 0, frecuentes = 0;
+        if (!(archivo_sketches >> etiqueta >> precision >> ancho >> profundidad >> frecuentes) || etiqueta != "configuracion"){
+            cout << "El archivo sketches.txt no es válido y no se cargó." << endl;
+            archivos_con_errores.insert("sketches.txt");
+        } else if (precision != PRECISION_HLL || ancho != ANCHO_COUNT_MIN || profundidad != PROFUNDIDAD_COUNT_MIN || frecuentes != CANTIDAD_FRECUENTES){
+            cout << "Los resúmenes de ventas guardados usan otra configuración y no se cargaron." << endl;
+        } else {
+            string periodo;
+            while (archivo_sketches >> etiqueta){
+                // Saltar lo que quede de un periodo dañado hasta el siguiente periodo:
+                if (etiqueta != "periodo"){
+                    continue;
+                }
+                SketchesVentas sketches;
+                if (archivo_sketches >> periodo && periodoValido(periodo) && leerSketchesPeriodo(archivo_sketches, sketches)){
+                    sketches_ventas[periodo] = sketches;
+                } else {
+                    cout << "Los resúmenes del periodo " << periodo << " están dañados y se descartaron." << endl;
+                    archivos_con_errores.insert("sketches.txt");
+                    archivo_sketches.clear();
+                }
+            }
+        }
+        archivo_sketches.close();
     }
 }
 
 
 // Función para guardar la información en archivos:
-void guardarInformacion(list<Producto> &productos, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria, list<Cliente> &clientes, list<Venta> &ventas, list<Vendedor> &vendedores, queue<Proveedor> &proveedores){
+void guardarInformacion(list<Producto> &productos, map<string, Producto> &productos_codigo, map<string, list<Producto>> &productos_categoria, list<Cliente> &clientes, list<Venta> &ventas, vector<DetalleVenta> &detalles_ventas, list<Vendedor> &vendedores, queue<Proveedor> &proveedores, TablaIds<Producto> &tabla_productos, TablaIds<Cliente> &tabla_clientes, TablaIds<Vendedor> &tabla_vendedores, TablaIds<Venta> &tabla_ventas, map<string, SketchesVentas> &sketches_ventas, set<string> &archivos_con_errores){
     // Guardar la información de los productos en un archivo:
-    ofstream archivo_productos("productos.txt");
-    for (list<Producto>::iterator it = productos.begin(); it != productos.end(); it++){
-        archivo_productos << it->codigo << " " << it->nombre << " " << it->precio << " " << it->cantidad << " " << it->descripcion << " " << it->categoria << " " << it->proveedor.nombre << " " << it->estado << endl;
+    if (puedeGuardarArchivo(archivos_con_errores, "productos.txt")){
+        ofstream archivo_productos("productos.txt");
+        for (list<Producto>::iterator it = productos.begin(); it != productos.end(); it++){
+            archivo_productos << it->id << " " << it->codigo << " " << it->nombre << " " << it->precio << " " << it->cantidad << " " << it->stock_minimo << " " << it->descripcion << " " << it->categoria << " " << it->proveedor.id << " " << it->proveedor.nombre << " " << it->estado << endl;
+        }
+        archivo_productos.close();
     }
-    archivo_productos.close();
     // Guardar la información de los clientes en un archivo:
-    ofstream archivo_clientes("clientes.txt");
-    for (list<Cliente>::iterator it = clientes.begin(); it != clientes.end(); it++){
-        archivo_clientes << it->nombre << " " << it->apellido << " " << it->telefono << " " << it->correo << " " << it->direccion << " " << it->nit << endl;
+    if (puedeGuardarArchivo(archivos_con_errores, "clientes.txt")){
+        ofstream archivo_clientes("clientes.txt");
+        for (list<Cliente>::iterator it = clientes.begin(); it != clientes.end(); it++){
+            archivo_clientes << it->id << " " << it->nombre << " " << it->apellido << " " << it->telefono << " " << it->correo << " " << it->direccion << " " << it->nit << endl;
+        }
+        archivo_clientes.close();
     }
-    archivo_clientes.close();
     // Guardar la información de las ventas en un archivo:
-    ofstream archivo_ventas("ventas.txt");
-    for (list<Venta>::iterator it = ventas.begin(); it != ventas.end(); it++){
-        archivo_ventas << it->nro_venta << " " << it->fecha << " " << it->cliente.nombre << " " << it->total << " " << it->vendedor.nombre << endl;
+    if (puedeGuardarArchivo(archivos_con_errores, "ventas.txt")){
+        ofstream archivo_ventas("ventas.txt");
+        for (list<Venta>::iterator it = ventas.begin(); it != ventas.end(); it++){
+            archivo_ventas << it->nro_venta << " " << it->fecha << " " << it->cliente.id << " " << it->cliente.nombre << " " << it->total << " " << it->vendedor.id << " " << it->vendedor.nombre << endl;
+        }
+        archivo_ventas.close();
+    }
+    // Guardar los detalles de las ventas en un archivo:
+    if (puedeGuardarArchivo(archivos_con_errores, "detalles.txt")){
+        ofstream archivo_detalles("detalles.txt");
+        for (vector<DetalleVenta>::iterator it = detalles_ventas.begin(); it != detalles_ventas.end(); it++){
+            archivo_detalles << it->nro_detalle << " " << it->venta.nro_venta << " " << it->producto.id << " " << it->producto.codigo << " " << it->producto.nombre << " " << it->producto.categoria << " " << it->producto.precio << " " << it->cantidad << " " << it->subtotal << endl;
+        }
+        archivo_detalles.close();
     }
-    archivo_ventas.close();
     // Guardar la información de los vendedores en un archivo:
-    ofstream archivo_vendedores("vendedores.txt");
-    for (list<Vendedor>::iterator it = vendedores.begin(); it != vendedores.end(); it++){
-        archivo_vendedores << it->nombre << " " << it->apellido << " " << it->telefono << " " << it->correo << " " << it->direccion << " " << it->salario << " " << it->ventas_realizadas << endl;
+    if (puedeGuardarArchivo(archivos_con_errores, "vendedores.txt")){
+        ofstream archivo_vendedores("vendedores.txt");
+        for (list<Vendedor>::iterator it = vendedores.begin(); it != vendedores.end(); it++){
+            archivo_vendedores << it->id << " " << it->nombre << " " << it->apellido << " " << it->telefono << " " << it->correo << " " << it->direccion << " " << it->salario << " " << it->ventas_realizadas << endl;
+        }
+        archivo_vendedores.close();
     }
-    archivo_vendedores.close();
     // Guardar la información de los proveedores en un archivo:
     ofstream archivo_proveedores("proveedores.txt");
     while (!proveedores.empty()){
@@ -743,6 +2233,42 @@ void guardarInformacion(list<Producto> &productos, map<string, Producto> &produc
         proveedores.pop();
     }
     archivo_proveedores.close();
+    // Guardar los siguientes ids a asignar:
+    if (puedeGuardarArchivo(archivos_con_errores, "ids.txt")){
+        ofstream archivo_ids("ids.txt");
+        archivo_ids << tabla_productos.siguiente_id << " " << tabla_clientes.siguiente_id << " " << tabla_vendedores.siguiente_id << " " << tabla_ventas.siguiente_id << endl;
+        archivo_ids.close();
+    }
+    // Guardar los resúmenes aproximados de ventas de cada periodo:
+    if (puedeGuardarArchivo(archivos_con_errores, "sketches.txt")){
+        ofstream archivo_sketches("sketches.txt");
+        archivo_sketches << "configuracion " << PRECISION_HLL << " " << ANCHO_COUNT_MIN << " " << PROFUNDIDAD_COUNT_MIN << " " << CANTIDAD_FRECUENTES << endl;
+        for (map<string, SketchesVentas>::iterator it = sketches_ventas.begin(); it != sketches_ventas.end(); it++){
+            SketchesVentas &sketches = it->second;
+            archivo_sketches << "periodo " << it->first << endl;
+            archivo_sketches << "count_min";
+            for (size_t i = 0; i < sketches.unidades_producto.contadores.size(); i++){
+                archivo_sketches << " " << sketches.unidades_producto.contadores[i];
+            }
+            archivo_sketches << endl;
+            archivo_sketches << "frecuentes " << sketches.frecuentes.size();
+            for (size_t i = 0; i < sketches.frecuentes.size(); i++){
+                archivo_sketches << " " << sketches.frecuentes[i].second << " " << sketches.frecuentes[i].first;
+            }
+            archivo_sketches << endl;
+            archivo_sketches << "productos " << sketches.clientes_producto.size() << endl;
+            for (map<string, HyperLogLog>::iterator it2 = sketches.clientes_producto.begin(); it2 != sketches.clientes_producto.end(); it2++){
+                archivo_sketches << it2->first << " ";
+                escribirHll(archivo_sketches, it2->second);
+            }
+            archivo_sketches << "vendedores " << sketches.clientes_vendedor.size() << endl;
+            for (map<int, HyperLogLog>::iterator it2 = sketches.clientes_vendedor.begin(); it2 != sketches.clientes_vendedor.end(); it2++){
+                archivo_sketches << it2->first << " ";
+                escribirHll(archivo_sketches, it2->second);
+            }
+        }
+        archivo_sketches.close();
+    }
 }
 
 
@@ -753,6 +2279,7 @@ void mostrarMenuPrincipal(){
     cout << "3. Ventas\n";
     cout << "4. Clientes\n";
     cout << "5. Listar Ventas\n";
+    cout << "6. Cierre de mes\n";
     cout << "0. Salir\n";
     cout << "Seleccione una opcion: ";
 }
@@ -763,6 +2290,10 @@ void mostrarMenuProductos(){
     cout << "2. Modificar producto\n";
     cout << "3. Eliminar producto\n";
     cout << "4. Mostrar productos\n";
+    cout << "5. Operación masiva sobre productos\n";
+    cout << "6. Cargar operaciones masivas desde archivo\n";
+    cout << "7. Mostrar productos con stock bajo\n";
+    cout << "8. Generar órdenes de compra\n";
     cout << "0. Volver al menú principal\n";
     cout << "Seleccione una opción: ";
 }
@@ -783,6 +2314,7 @@ void mostrarMenuVentas(){
     cout << "1. Agregar venta\n";
     cout << "2. Mostrar ventas\n";
     cout << "3. Mostrar detalle de venta\n";
+    cout << "4. Tablero aproximado de ventas\n";
     cout << "0. Volver al menú principal\n";
     cout << "Seleccione una opción: ";
 }